@@ -147,11 +147,27 @@ INT32 kSemaQuery(K_SEMA* const kobj);
 
 K_ERR kMutexInit(K_MUTEX* const kobj);
 
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+/**
+ *\brief Init a priority ceiling mutex. The locking task is raised
+ *       to the ceiling as soon as it acquires the lock. On unlock it
+ *       drops to the highest ceiling of the mutexes it still holds
+ *       (its real priority if none), so nested ceiling mutexes can be
+ *       unlocked in any order. No priority inheritance takes place.
+ *\param kobj    mutex address
+ *\param ceiling highest priority among the tasks that lock this mutex
+ *\return K_SUCCESS / K_ERR_INVALID_PRIO
+ */
+K_ERR kMutexInitCeil(K_MUTEX* const kobj, PRIO const ceiling);
+#endif
+
 /**
  *\brief Lock 		a mutex
  *\param kobj 		mutex address
  *\param timeout	Maximum suspension time
  *\return K_SUCCESS or a specific error \see ktypes.h
+ *        K_ERR_MUTEX_CEIL_VIOL if the caller base priority is higher than
+ *        the mutex ceiling.
  */
 K_ERR kMutexLock(K_MUTEX* const kobj, TICK timeout);
 
@@ -219,12 +235,92 @@ BOOL kMboxIsFull(K_MBOX *const kobj);
 /**
  * \brief				Initialises an indirect multi-item mailbox.
  * \param kobj			Mailbox address.
- * \param memPtr		Pointer to the mailbox memory.
- * \param maxItems		Maximum number of items.
- * \return
+ * \param memPtr		Pointer to the mailbox memory: an array of
+ * 						maxItems ADDR.
+ * \param maxItems		Maximum number of items. Must be a power of two.
+ * \return				K_SUCCESS or K_ERR_MBOX_SIZE.
  */
 K_ERR kMboxInit(K_MBOX *const kobj, ADDR memPtr, SIZE maxItems);
 
+/**
+ * \brief               Post to a mailbox without blocking.
+ * \param kobj          Mailbox address.
+ * \param sendPtr       Mail address.
+ * \return              K_SUCCESS or K_ERR_MBOX_FULL.
+ */
+K_ERR kMboxTryPost(K_MBOX *const kobj, ADDR const sendPtr);
+
+/**
+ * \brief               Post to a mailbox from an interrupt handler.
+ *                      Never blocks.
+ * \param kobj          Mailbox address.
+ * \param sendPtr       Mail address.
+ * \return              K_SUCCESS or K_ERR_MBOX_FULL.
+ */
+K_ERR kMboxPostFromISR(K_MBOX *const kobj, ADDR const sendPtr);
+
+/**
+ * \brief               Receive from a mailbox without blocking.
+ * \param kobj          Mailbox address.
+ * \param recvPPtr      Address that will store the mail address.
+ * \return              K_SUCCESS or K_ERR_MBOX_EMPTY.
+ */
+K_ERR kMboxTryPend(K_MBOX *const kobj, ADDR *const recvPPtr);
+
+/**
+ * \brief               Read the oldest mail without removing it.
+ * \param kobj          Mailbox address.
+ * \param peekPPtr      Address that will store the mail address.
+ * \return              K_SUCCESS or K_ERR_MBOX_EMPTY.
+ */
+K_ERR kMboxPeek(K_MBOX *const kobj, ADDR *peekPPtr);
+
+/**
+ * \brief   Check if a mailbox is full.
+ * \return  TRUE or FALSE.
+ */
+BOOL kMboxIsFull(K_MBOX *const kobj);
+
+#if (K_DEF_QWATERMARK==ON)
+/**
+ *\brief 			Set the high and low watermarks of a mailbox. Reaching
+ *\					high, and then falling back to low, each fire once.
+ *\param kobj		Mailbox address
+ *\param high		High watermark (1 to capacity)
+ *\param low		Low watermark (below high)
+ *\param callback	Called with (kobj, TRUE/FALSE for high/low, argPtr).
+ *\					Runs in a critical section; must not block. Can be NULL.
+ *\param argPtr		Callback argument
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kMboxSetWatermarks(K_MBOX *const kobj, SIZE const high, SIZE const low,
+		K_QWM_CALLBACK const callback, ADDR const argPtr);
+
+#if (K_DEF_TASK_NOTIFY==ON)
+/**
+ *\brief 			Notify a task on watermark crossings (K_NOTIFY_SET_BITS)
+ *\param kobj		Mailbox address
+ *\param taskID		Task to notify
+ *\param highBits	Bits set when the high watermark is reached
+ *\param lowBits	Bits set when the low watermark is reached
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kMboxWatermarkNotify(K_MBOX *const kobj, TID const taskID,
+		UINT32 const highBits, UINT32 const lowBits);
+#endif
+
+/**
+ *\brief 			Read the fill statistics of a mailbox: peak depth, ticks
+ *\					spent over the high watermark, blocked sends.
+ *\param kobj		Mailbox address
+ *\param statsPtr	Address to store the statistics
+ *\param clear		TRUE resets them after reading
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kMboxGetQStats(K_MBOX *const kobj, K_QSTATS *const statsPtr,
+		BOOL const clear);
+#endif
+
 /**
  * \brief   Get the number of mails on a mailbox.
  * \return  Number of mails.
@@ -301,6 +397,33 @@ K_ERR kMesgQRecv(K_MESGQ *const kobj, ADDR recvPtr, TICK timeout);
  */
 K_ERR kMesgQSend(K_MESGQ *const kobj, ADDR const sendPtr, TICK timeout);
 
+/**
+ *\brief 			Send a message gathered from fragments, copied straight
+ *\					into the queue (or into a waiting receiver). Blocks
+ *\					as kMesgQSend.
+ *\param kobj		Queue address
+ *\param frags		Array of {pointer, length}. The lengths must add up
+ *\					to the message size.
+ *\param nFrags		Number of fragments
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kMesgQSendV(K_MESGQ *const kobj, K_MESG_FRAG const *const frags,
+		SIZE const nFrags, TICK const timeout);
+
+/**
+ *\brief 			Receive a message scattered into fragments. Blocks
+ *\					as kMesgQRecv.
+ *\param kobj		Queue address
+ *\param frags		Array of {pointer, length}. The lengths must add up
+ *\					to the message size.
+ *\param nFrags		Number of fragments
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kMesgQRecvV(K_MESGQ *const kobj, K_MESG_FRAG const *const frags,
+		SIZE const nFrags, TICK const timeout);
+
 
 /**
 *\brief 			Receive the front message of a queue
@@ -318,9 +441,692 @@ K_ERR kMesgQPeek(K_MESGQ *const kobj, ADDR recvPtr);
  */
 K_ERR kMesgQReset(K_MESGQ* kobj);
 
+#if (K_DEF_QWATERMARK==ON)
+/**
+ *\brief 			Set the high and low watermarks of a queue. Reaching
+ *\					high, and then falling back to low, each fire once.
+ *\param kobj		Queue address
+ *\param high		High watermark (1 to maxMessages)
+ *\param low		Low watermark (below high)
+ *\param callback	Called with (kobj, TRUE/FALSE for high/low, argPtr).
+ *\					Runs in a critical section; must not block. Can be NULL.
+ *\param argPtr		Callback argument
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kMesgQSetWatermarks(K_MESGQ *const kobj, SIZE const high, SIZE const low,
+		K_QWM_CALLBACK const callback, ADDR const argPtr);
+
+#if (K_DEF_TASK_NOTIFY==ON)
+/**
+ *\brief 			Notify a task on watermark crossings (K_NOTIFY_SET_BITS)
+ *\param kobj		Queue address
+ *\param taskID		Task to notify
+ *\param highBits	Bits set when the high watermark is reached
+ *\param lowBits	Bits set when the low watermark is reached
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kMesgQWatermarkNotify(K_MESGQ *const kobj, TID const taskID,
+		UINT32 const highBits, UINT32 const lowBits);
+#endif
+
+/**
+ *\brief 			Read the fill statistics of a queue: peak depth, ticks
+ *\					spent over the high watermark, blocked sends.
+ *\param kobj		Queue address
+ *\param statsPtr	Address to store the statistics
+ *\param clear		TRUE resets them after reading
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kMesgQGetQStats(K_MESGQ *const kobj, K_QSTATS *const statsPtr,
+		BOOL const clear);
+#endif
+
+#if (K_DEF_MESGQ_OVERWRITE==ON)
+/**
+ *\brief 			Set the overwrite-oldest mode of a queue. When set, a send
+ *\					to a full queue discards the oldest message and never
+ *\					blocks.
+ *\param kobj		Queue address
+ *\param overwrite	TRUE to overwrite, FALSE to block (default)
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kMesgQSetOverwrite(K_MESGQ *const kobj, BOOL const overwrite);
+
+/**
+ *\brief 			Get the number of messages discarded by overwrites.
+ *\param kobj		Queue address
+ *\param dropCntPtr	Address to store the drop counter
+ *\param clear		TRUE resets the counter after reading
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kMesgQGetDropCount(K_MESGQ *const kobj, UINT32 *const dropCntPtr,
+		BOOL const clear);
+#endif
+
+
+#if (K_DEF_PMESGQ==ON)
+/**
+ *\brief 			Initialise a Priority Message Queue
+ *\param kobj		Queue address
+ *\param buffer		Allocated memory: messageSize*maxMessages bytes
+ *\param nodes		Array of maxMessages heap nodes
+ *\param messageSize Message size
+ *\param maxMessages Max number of messages (up to 65535)
+ *\return 			K_SUCCESS or specific errors
+ */
+K_ERR kPMesgQInit(K_PMESGQ *const kobj, ADDR const buffer,
+		K_PMESGQ_NODE *const nodes, SIZE const messageSize,
+		SIZE const maxMessages);
+
+/**
+ *\brief 			Send a message with a priority (0 is the highest)
+ *\param kobj		Queue address
+ *\param sendPtr	Message address
+ *\param prio		Message priority
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kPMesgQSend(K_PMESGQ *const kobj, ADDR const sendPtr, PRIO const prio,
+		TICK const timeout);
+
+/**
+ *\brief 			Receive the highest-priority message. Equal priorities
+ *\					are received in arrival order.
+ *\param kobj		Queue address
+ *\param recvPtr	Receiving address
+ *\param prioPtr	Address to store the message priority (can be NULL)
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kPMesgQRecv(K_PMESGQ *const kobj, ADDR recvPtr, PRIO *const prioPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Get the current number of messages
+ *\param kobj		Queue address
+ *\param mesgCntPtr Address to store the message number
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kPMesgQGetMesgCount(K_PMESGQ *const kobj, UINT32 *const mesgCntPtr);
+#endif
 
 #endif /*K_DEF_MESGQ*/
 
+/*******************************************************************************
+ * BROADCAST RING
+ *******************************************************************************/
+#if (K_DEF_BCAST == ON)
+/**
+ *\brief 			Initialise a broadcast ring
+ *\param kobj		Ring address
+ *\param buffer		Allocated memory: messageSize*maxMessages bytes
+ *\param messageSize Message size
+ *\param maxMessages Ring capacity. Must be a power of two.
+ *\param policy		K_BCAST_WAIT: writer blocks on the slowest reader.
+ *\					K_BCAST_OVERWRITE: writer never blocks.
+ *\return 			K_SUCCESS or specific errors
+ */
+K_ERR kBcastInit(K_BCAST *const kobj, ADDR const buffer, SIZE const messageSize,
+		SIZE const maxMessages, K_BCAST_POLICY const policy);
+
+/**
+ *\brief 			Register a reader. It will receive every message
+ *\					published from now on.
+ *\param kobj		Ring address
+ *\param reader		Reader cursor (owned by the reading task)
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kBcastAttach(K_BCAST *const kobj, K_BCAST_READER *const reader);
+
+/**
+ *\brief 			Unregister a reader. A reader that stops reading must
+ *\					be detached: with K_BCAST_WAIT it would block the
+ *\					writer forever. A task blocked on it returns
+ *\					K_ERR_TIMEOUT.
+ *\param reader		Reader cursor
+ *\return			K_SUCCESS, K_ERR_OBJ_NULL, or K_ERR_OBJ_NOT_INIT if not
+ *\					attached
+ */
+K_ERR kBcastDetach(K_BCAST_READER *const reader);
+
+/**
+ *\brief 			Publish a message to all readers. Can be called from
+ *\					an ISR with timeout 0.
+ *\param kobj		Ring address
+ *\param sendPtr	Message address
+ *\param timeout	Suspension time (K_BCAST_WAIT policy only)
+ *\return			K_SUCCESS, K_ERR_BCAST_FULL or specific error
+ */
+K_ERR kBcastPublish(K_BCAST *const kobj, ADDR const sendPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Copy the next message of a reader and advance it
+ *\param reader		Reader cursor
+ *\param recvPtr	Receiving address
+ *\param timeout	Suspension time while there is nothing new
+ *\return			K_SUCCESS, K_ERR_BCAST_EMPTY or specific error
+ */
+K_ERR kBcastRead(K_BCAST_READER *const reader, ADDR const recvPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Get the address of the next message in the ring,
+ *\					without copying. The reader keeps the message until
+ *\					kBcastRelease.
+ *\param reader		Reader cursor
+ *\param slotPPtr	Address to store the message address
+ *\param timeout	Suspension time while there is nothing new
+ *\return			K_SUCCESS, K_ERR_BCAST_EMPTY or specific error
+ */
+K_ERR kBcastAcquire(K_BCAST_READER *const reader, ADDR *const slotPPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Advance a reader past the acquired message
+ *\param reader		Reader cursor
+ *\return			K_SUCCESS, or K_ERR_BCAST_LAGGED if the message was
+ *\					overwritten while held (K_BCAST_OVERWRITE).
+ */
+K_ERR kBcastRelease(K_BCAST_READER *const reader);
+
+/**
+ *\brief 			Get the number of messages a reader missed by being
+ *\					lapped (K_BCAST_OVERWRITE)
+ *\param reader		Reader cursor
+ *\param lostPtr	Address to store the counter
+ *\param clear		TRUE resets the counter after reading
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kBcastGetLost(K_BCAST_READER *const reader, UINT32 *const lostPtr,
+		BOOL const clear);
+#endif
+
+/*******************************************************************************
+ * SNAPSHOT CHANNEL
+ *******************************************************************************/
+#if (K_DEF_SNAP == ON)
+/**
+ *\brief 			Initialise a latest-value snapshot channel
+ *\param kobj		Channel address
+ *\param buffer		Allocated memory: 3*messageSize bytes
+ *\param messageSize Message size
+ *\return 			K_SUCCESS or specific errors
+ */
+K_ERR kSnapInit(K_SNAP *const kobj, ADDR const buffer, SIZE const messageSize);
+
+/**
+ *\brief 			Publish a new value. Never blocks; ISR-safe.
+ *\param kobj		Channel address
+ *\param sendPtr	Value address
+ *\return			K_SUCCESS, or K_ERR_SNAP_BUSY if another write is in
+ *\					progress.
+ */
+K_ERR kSnapWrite(K_SNAP *const kobj, ADDR const sendPtr);
+
+/**
+ *\brief 			Copy the latest value. Interrupts are not masked.
+ *\param kobj		Channel address
+ *\param recvPtr	Receiving address
+ *\param versionPtr In: last version seen (0 for none). Out: version read.
+ *\					Can be NULL.
+ *\return			K_SUCCESS, K_ERR_SNAP_SEEN if the version is unchanged
+ *\					or K_ERR_SNAP_EMPTY if nothing was written yet.
+ */
+K_ERR kSnapRead(K_SNAP *const kobj, ADDR const recvPtr,
+		UINT32 *const versionPtr);
+
+/**
+ *\brief 			Current version of a channel (0 if never written)
+ */
+UINT32 kSnapVersion(K_SNAP *const kobj);
+#endif
+
+/*******************************************************************************
+ * PUBLISH/SUBSCRIBE BUS
+ *******************************************************************************/
+#if (K_DEF_BUS == ON)
+/**
+ *\brief 			Initialise a topic
+ *\param kobj		Topic address
+ *\param name		Topic name
+ *\param memPtr		Block pool for the messages. Each block holds a
+ *\					K_BUS_MSG header followed by the payload.
+ *\return 			K_SUCCESS or specific errors
+ */
+K_ERR kBusTopicInit(K_BUS_TOPIC *const kobj, STRING const name,
+		K_MEM *const memPtr);
+
+/**
+ *\brief 			Subscribe with a queue of pending messages
+ *\param kobj		Topic address
+ *\param sub		Subscriber address
+ *\param ringPtr	Array of depth message pointers
+ *\param depth		Pending messages kept. Must be a power of two.
+ *\					When full, the oldest one is dropped.
+ *\return 			K_SUCCESS or specific errors
+ */
+K_ERR kBusSubscribe(K_BUS_TOPIC *const kobj, K_BUS_SUB *const sub,
+		K_BUS_MSG **const ringPtr, SIZE const depth);
+
+/**
+ *\brief 			Subscribe with a callback, run in the publisher context.
+ *\					Call kBusRetain to keep the message after returning.
+ *\param kobj		Topic address
+ *\param sub		Subscriber address
+ *\param callback	Callback
+ *\param argPtr		Callback argument
+ *\return 			K_SUCCESS or specific errors
+ */
+K_ERR kBusSubscribeCallback(K_BUS_TOPIC *const kobj, K_BUS_SUB *const sub,
+		K_BUS_CALLBACK const callback, ADDR const argPtr);
+
+/**
+ *\brief 			Remove a subscriber from its topic. Messages still on
+ *\					its ring are released; a task blocked on it in
+ *\					kBusRecv returns K_ERR_TIMEOUT. Must be called before
+ *\					the subscriber (or its task) goes away.
+ *\param sub		Subscriber address
+ *\return 			K_SUCCESS, K_ERR_OBJ_NULL, or K_ERR_OBJ_NOT_INIT if not
+ *\					subscribed
+ */
+K_ERR kBusUnsubscribe(K_BUS_SUB *const sub);
+
+/**
+ *\brief 			Allocate a message to be filled and published
+ *\param kobj		Topic address
+ *\return			Message (payload at ->data) or NULL if the pool is empty
+ */
+K_BUS_MSG* kBusAlloc(K_BUS_TOPIC *const kobj);
+
+/**
+ *\brief 			Publish a message to every subscriber, without copies.
+ *\					The publisher reference is handed over.
+ *\param kobj		Topic address
+ *\param msgPtr		Message from kBusAlloc
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kBusPublish(K_BUS_TOPIC *const kobj, K_BUS_MSG *const msgPtr);
+
+/**
+ *\brief 			Receive the next message of a queued subscriber. The
+ *\					caller owns a reference and must kBusRelease it.
+ *\param sub		Subscriber address
+ *\param msgPPtr	Address to store the message
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS, K_ERR_BUS_EMPTY (timeout 0), K_ERR_TIMEOUT,
+ *\					K_ERR_OBJ_NULL, or K_ERR_OBJ_NOT_INIT if not subscribed
+ */
+K_ERR kBusRecv(K_BUS_SUB *const sub, K_BUS_MSG **const msgPPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Take one more reference to a message
+ */
+VOID kBusRetain(K_BUS_MSG *const msgPtr);
+
+/**
+ *\brief 			Drop a reference. The last one frees the block.
+ */
+K_ERR kBusRelease(K_BUS_MSG *const msgPtr);
+
+/**
+ *\brief 			Read the statistics of a topic
+ *\param kobj		Topic address
+ *\param statsPtr	Address to store the statistics
+ *\param clear		TRUE resets drops, intervals and lag peaks
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kBusGetStats(K_BUS_TOPIC *const kobj, K_BUS_STATS *const statsPtr,
+		BOOL const clear);
+#endif
+
+/*******************************************************************************
+ * RENDEZVOUS
+ *******************************************************************************/
+#if (K_DEF_RDV == ON)
+/**
+ *\brief 			Initialise a rendezvous
+ *\param kobj		Rendezvous address
+ *\return 			K_SUCCESS or specific errors
+ */
+K_ERR kRdvInit(K_RDV *const kobj);
+
+/**
+ *\brief 			Send a request and wait for the reply. Both are passed
+ *\					by reference and must stay valid until the call returns.
+ *\param kobj		Rendezvous address
+ *\param reqPtr		Request address
+ *\param replyPPtr	Address to store the reply address (can be NULL)
+ *\param timeout		Ticks to wait for the server to accept the call. Once
+ *\					accepted, the client waits for the reply.
+ *\return			K_SUCCESS, K_ERR_RDV_NO_SERVER, K_ERR_TIMEOUT or
+ *\					specific error
+ */
+K_ERR kRdvCall(K_RDV *const kobj, ADDR const reqPtr, ADDR *const replyPPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Take the highest priority call. The server runs at the
+ *\					client priority, if higher, until it replies.
+ *\param kobj		Rendezvous address
+ *\param reqPPtr		Address to store the request address
+ *\param timeout		Suspension time-out
+ *\return			K_SUCCESS, K_ERR_RDV_NO_CALLER, K_ERR_TIMEOUT,
+ *\					K_ERR_RDV_BUSY if a call is not replied yet
+ */
+K_ERR kRdvAccept(K_RDV *const kobj, ADDR *const reqPPtr, TICK const timeout);
+
+/**
+ *\brief 			Reply to the accepted call and release its client
+ *\param kobj		Rendezvous address
+ *\param replyPtr	Reply address, returned to the client
+ *\return			K_SUCCESS or K_ERROR if the caller did not accept a call
+ */
+K_ERR kRdvReply(K_RDV *const kobj, ADDR const replyPtr);
+#endif
+
+/*******************************************************************************
+ * KERNEL STATISTICS
+ *******************************************************************************/
+#if (K_DEF_STATS == ON)
+/**
+ *\brief 			Report the fill of a queue or pool in the statistics
+ *\					block (up to K_DEF_STATS_NOBJS objects)
+ *\param kobj		Object address
+ *\param type		Object type
+ *\param name		Name shown by the monitor
+ *\return			K_SUCCESS, K_ERR_OBJ_NULL, or K_ERROR if full
+ */
+K_ERR kStatsRegister(ADDR const kobj, K_STATS_OBJ const type,
+		STRING const name);
+
+/**
+ *\brief 			Refresh the statistics block kStats. CPU shares are
+ *\					over the time since the previous refresh.
+ */
+VOID kStatsUpdate(VOID);
+
+/**
+ *\brief 			Monitor task entry. Create it with a low priority; it
+ *\					refreshes kStats every K_DEF_STATS_PERIOD ticks and
+ *\					prints the tasks, busiest first, and the registered
+ *\					objects.
+ */
+VOID kStatsTask(VOID);
+
+/**
+ *\brief 			Set the byte sink used by the monitor task, called once
+ *\					per line.
+ *\param outputFn	Output function, or NULL for the default: the kLog
+ *\					ring with K_DEF_LOG in text mode, else the UART
+ *\					(_write, blocking)
+ */
+VOID kStatsSetOutput(K_STATS_OUTPUT const outputFn);
+#endif
+
+/*******************************************************************************
+ * CPU LOAD
+ *******************************************************************************/
+#if (K_DEF_CPULOAD == ON)
+/**
+ *\brief 			Get the CPU load: the share of time the idle task was
+ *\					not sleeping, in permille, averaged over the last
+ *\					K_DEF_CPULOAD_WIN_SHORT, _MID and _LONG seconds.
+ *\param loadPtr		Address to store the loads and the one-second peak
+ *\param clearPeak	TRUE resets the peak after reading
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kCpuLoadGet(K_CPULOAD *const loadPtr, BOOL const clearPeak);
+#endif
+
+/*******************************************************************************
+ * STACK MONITOR
+ *******************************************************************************/
+#if (K_DEF_STACKMON == ON)
+/**
+ *\brief 			Get the stack high-water mark of a task: the deepest
+ *\					the task has used its stack since it was created.
+ *\param taskID		Task ID
+ *\param usedPtr		Address to store the words used
+ *\param sizePtr		Address to store the stack size in words, or NULL
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kStackGetUsage(TID const taskID, UINT32 *const usedPtr,
+		UINT32 *const sizePtr);
+#endif
+
+/*******************************************************************************
+ * CONTENTION PROFILER
+ *******************************************************************************
+ * A wait is counted when a task blocks on the object, and lasts (in CPU
+ * cycles) until the task is switched in again.
+ *******************************************************************************/
+#if (K_DEF_CONTENTION == ON)
+#if (K_DEF_SEMA == ON)
+/**
+ *\brief 			Read the blocking waits on a semaphore
+ *\param kobj		Semaphore address
+ *\param statsPtr	Address to store waits, time-outs, total and maximum
+ *\					cycles blocked
+ *\param clear		TRUE resets the statistics after reading
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kSemaGetContention(K_SEMA *const kobj, K_CONTENTION *const statsPtr,
+		BOOL const clear);
+#endif
+#if (K_DEF_MUTEX == ON)
+/**
+ *\brief 			Read the blocking waits on a mutex. maxHolder is the
+ *\					owner during the longest wait.
+ *\param kobj		Mutex address
+ *\param statsPtr	Address to store the statistics
+ *\param holderCyclesPtr Array of NTHREADS words, or NULL: cycles others
+ *\					waited while each task (by PID) held the mutex
+ *\param clear		TRUE resets the statistics after reading
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kMutexGetContention(K_MUTEX *const kobj, K_CONTENTION *const statsPtr,
+		UINT32 *const holderCyclesPtr, BOOL const clear);
+#endif
+#if (K_DEF_MBOX == ON)
+/**
+ *\brief 			Read the blocking sends and receives on a mailbox
+ *\param kobj		Mailbox address
+ *\param statsPtr	Address to store the statistics
+ *\param clear		TRUE resets the statistics after reading
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kMboxGetContention(K_MBOX *const kobj, K_CONTENTION *const statsPtr,
+		BOOL const clear);
+#endif
+#if (K_DEF_MESGQ == ON)
+/**
+ *\brief 			Read the blocking sends and receives on a message queue
+ *\param kobj		Queue address
+ *\param statsPtr	Address to store the statistics
+ *\param clear		TRUE resets the statistics after reading
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kMesgQGetContention(K_MESGQ *const kobj, K_CONTENTION *const statsPtr,
+		BOOL const clear);
+#endif
+/**
+ *\brief 			Time a task spent blocked, by object
+ *\param taskID		Task ID
+ *\param slotsPtr	Array of K_DEF_CONTENTION_SLOTS entries {object, waits,
+ *\					cycles}; unused entries have a NULL object
+ *\param otherPtr	Address to store the cycles blocked on objects that did
+ *\					not fit the slots, or NULL
+ *\param clear		TRUE resets the task statistics
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kTaskGetContention(TID const taskID, K_CONTENTION_SLOT *const slotsPtr,
+		UINT64 *const otherPtr, BOOL const clear);
+#endif
+
+/*******************************************************************************
+ * WAKE-UP LATENCY
+ *******************************************************************************/
+#if (K_DEF_LATENCY == ON)
+/**
+ *\brief 			Read the wake-up latency of a task: CPU cycles from
+ *\					the wake request (e.g. kSignal or kSemaSignal from an
+ *\					ISR) to the task being switched in.
+ *\param taskID		Task ID
+ *\param latPtr		Address to store count, min, max, mean and the log2
+ *\					histogram
+ *\param clear		TRUE resets the task statistics
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kLatencyGet(TID const taskID, K_LATENCY *const latPtr, BOOL const clear);
+#endif
+
+/*******************************************************************************
+ * DEFERRED LOGGING
+ *******************************************************************************/
+#if (K_DEF_LOG == ON)
+/**
+ *\brief 			Store a log record. Formatting and output are left to
+ *\					kLogTask. Use kLog(fmt, ...) instead.
+ *\param fmt		printf format string; it is not copied, so it must be a
+ *\					literal (or outlive the record)
+ *\param nArgs		Number of arguments used (up to 4)
+ *\return			K_SUCCESS, or K_ERR_LOG_FULL if the record was dropped
+ */
+K_ERR kLogWrite(STRING const fmt, BYTE const nArgs, UINT32 const arg0,
+		UINT32 const arg1, UINT32 const arg2, UINT32 const arg3);
+
+#define K_LOG0_(f) kLogWrite((f), 0, 0, 0, 0, 0)
+#define K_LOG1_(f, a) kLogWrite((f), 1, (UINT32) (a), 0, 0, 0)
+#define K_LOG2_(f, a, b) kLogWrite((f), 2, (UINT32) (a), (UINT32) (b), 0, 0)
+#define K_LOG3_(f, a, b, c) kLogWrite((f), 3, (UINT32) (a), (UINT32) (b), \
+		(UINT32) (c), 0)
+#define K_LOG4_(f, a, b, c, d) kLogWrite((f), 4, (UINT32) (a), (UINT32) (b), \
+		(UINT32) (c), (UINT32) (d))
+#define K_LOG_SEL_(_1, _2, _3, _4, _5, N, ...) N
+
+/**
+ *\brief 			Log from a task or an ISR without blocking:
+ *\					kLog("adc %u ch %u\n", val, ch);
+ *\					Up to four integer, character or pointer arguments.
+ */
+#define kLog(...) K_LOG_SEL_(__VA_ARGS__, K_LOG4_, K_LOG3_, K_LOG2_, \
+		K_LOG1_, K_LOG0_, 0)(__VA_ARGS__)
+
+/**
+ *\brief 			Log task entry. Create it with a low priority; it
+ *\					drains the ring every K_DEF_LOG_PERIOD ticks.
+ */
+VOID kLogTask(VOID);
+
+/**
+ *\brief 			Format and output the pending records now. Called by
+ *\					kLogTask; call it elsewhere only if kLogTask is not used.
+ *\return			Number of records output
+ */
+UINT32 kLogFlush(VOID);
+
+/**
+ *\brief 			Set the byte sink used by the log task
+ *\param outputFn	Output function, or NULL for the UART (_write)
+ */
+VOID kLogSetOutput(K_LOG_OUTPUT const outputFn);
+
+/**
+ *\brief 			Get the number of records dropped on a full ring
+ *\param overrunsPtr	Address to store the counter
+ *\param clear		TRUE resets the counter after reading
+ *\return			K_SUCCESS or K_ERR_OBJ_NULL
+ */
+K_ERR kLogGetOverruns(UINT32 *const overrunsPtr, BOOL const clear);
+#endif
+
+/*******************************************************************************
+ * CRASH DUMP
+ *******************************************************************************/
+#if (K_DEF_CRASHDUMP == ON)
+/**
+ *\brief 			Get the record saved by the last fault, on the boot
+ *\					after it
+ *\return			The record, or NULL if there is none or it was cleared
+ */
+K_CRASH_DUMP const* kCrashDumpGet(VOID);
+
+/**
+ *\brief 			Mark the record as read. The crash counter is kept.
+ */
+VOID kCrashDumpClear(VOID);
+
+/**
+ *\brief 			CPU exception entry: branch to it from HardFault_Handler
+ *\					(and MemManage, BusFault, UsageFault) to save the
+ *\					stacked registers.
+ */
+VOID kFaultEntry(VOID);
+#endif
+
+/*******************************************************************************
+ * PC SAMPLING PROFILER
+ *******************************************************************************/
+#if (K_DEF_PCSAMPLE == ON)
+/**
+ *\brief 			Take a PC sample. Called by the tick handler with
+ *\					K_DEF_PCSAMPLE_TICK; otherwise call it from the
+ *\					interrupt handler of a faster timer.
+ */
+VOID kPcSampleISR(VOID);
+
+/**
+ *\brief 			Resume sampling. Sampling starts on kInit.
+ */
+VOID kPcSampleStart(VOID);
+
+/**
+ *\brief 			Pause sampling; the counts are kept.
+ */
+VOID kPcSampleStop(VOID);
+
+/**
+ *\brief 			Clear all counts.
+ */
+VOID kPcSampleClear(VOID);
+#endif
+
+/*******************************************************************************
+ * TRACE RECORDER
+ *******************************************************************************/
+#if (K_DEF_TRACE == ON)
+/**
+ *\brief 			Resume recording. Recording starts on kInit.
+ */
+VOID kTraceStart(VOID);
+
+/**
+ *\brief 			Stop recording; the ring keeps the last events.
+ */
+VOID kTraceStop(VOID);
+
+/**
+ *\brief 			Record the entry of an interrupt handler. Call it first
+ *\					thing in the handler.
+ */
+VOID kTraceISREnter(VOID);
+
+/**
+ *\brief 			Record the exit of an interrupt handler. Call it last
+ *\					thing in the handler.
+ */
+VOID kTraceISRExit(VOID);
+
+/**
+ *\brief 			Record an application event
+ *\param id			Event identifier
+ *\param valPtr		Any word (address or value)
+ */
+VOID kTraceUser(UINT16 const id, ADDR const valPtr);
+#endif
+
 /*******************************************************************************
  * PUMP-DROP QUEUE (CYCLIC ASYNCHRONOUS BUFFERS - CABs)
  *******************************************************************************/
@@ -421,6 +1227,39 @@ K_ERR kSignal(TID const taskID);
  */
 K_ERR kSuspend(TID const id);
 
+#if (K_DEF_TASK_NOTIFY==ON)
+/******************************************************************************
+ * TASK NOTIFICATION
+ ******************************************************************************/
+/**
+ * \brief          Send a notification to a task, updating its value.
+ *                 A task waiting on kNotifyWait is readied.
+ * \param taskID   User-assigned task ID
+ * \param value    Argument for the action
+ * \param action   K_NOTIFY_NONE, K_NOTIFY_SET_BITS, K_NOTIFY_INCREMENT
+ *                 or K_NOTIFY_OVERWRITE
+ * \return         K_SUCCESS or specific error
+ */
+K_ERR kNotify(TID const taskID, UINT32 const value,
+		K_NOTIFY_ACTION const action);
+
+/**
+ * \brief          Same as kNotify, to be called from an ISR.
+ */
+K_ERR kNotifyFromISR(TID const taskID, UINT32 const value,
+		K_NOTIFY_ACTION const action);
+
+/**
+ * \brief          Wait for a notification to the caller task.
+ * \param valuePtr Address to store the notification value (can be NULL)
+ * \param clear    If TRUE, the value is zeroed once taken
+ * \param timeout  Suspension time
+ * \return         K_SUCCESS, K_ERR_NOTIFY_EMPTY (no wait) or K_ERR_TIMEOUT
+ */
+K_ERR kNotifyWait(UINT32 *const valuePtr, BOOL const clear,
+		TICK const timeout);
+#endif
+
 /******************************************************************************
  * EVENTS
  ******************************************************************************/
@@ -535,6 +1374,31 @@ ADDR kMemAlloc(K_MEM* const kobj);
  */
 K_ERR kMemFree(K_MEM* const kobj, ADDR const blockPtr);
 
+#if (K_DEF_SHBUF == ON)
+/**
+ * \brief Allocate a shared buffer from a block pool, with one reference.
+ *        The payload is at ->data, ->size bytes long.
+ * \param kobj Pointer to the block pool
+ * \return Shared buffer handle, or NULL on failure
+ */
+K_SHBUF* kShBufAlloc(K_MEM* const kobj);
+
+/**
+ * \brief Take one more reference to a shared buffer (ISR-safe)
+ * \param bufPtr Shared buffer handle
+ * \return K_SUCCESS, or K_ERROR if the buffer was already freed
+ */
+K_ERR kShBufRetain(K_SHBUF* const bufPtr);
+
+/**
+ * \brief Drop a reference to a shared buffer (ISR-safe). The last one
+ *        returns the block to its pool.
+ * \param bufPtr Shared buffer handle
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kShBufRelease(K_SHBUF* const bufPtr);
+#endif
+
 /*******************************************************************************
  * MISC
  ******************************************************************************/
@@ -580,6 +1444,39 @@ extern K_TCB* runPtr;
 #define K_RUNNING_PRIO (runPtr->priority)
 
 
+/*******************************************************************************
+ * SERVICE PROFILING
+ *******************************************************************************/
+#if (K_DEF_PROFILE == ON)
+/* the service table and the wrappers of every service declared above */
+#include "kprof.h"
+
+/**
+ *\brief 			Read the statistics of a service
+ *\param svc			Service, K_PROF_<function name> (e.g. K_PROF_kSemaWait)
+ *\param statPtr		Address to store the statistics (cycles)
+ *\param clear		TRUE resets the service statistics
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kProfGet(K_PROF_SVC const svc, K_PROF_STAT *const statPtr,
+		BOOL const clear);
+
+/**
+ *\brief 			Longest interrupt-masked window seen (K_ENTER_CR to the
+ *\					outermost K_EXIT_CR), in cycles
+ *\param wherePtr	Address to store the return address of the K_EXIT_CR
+ *\					that closed it (can be NULL)
+ *\param clear		TRUE restarts the measurement
+ */
+UINT32 kProfGetMask(ADDR *const wherePtr, BOOL const clear);
+
+/**
+ *\brief 			Print a table of every service called so far
+ *\param printFn		printf-like function
+ */
+VOID kProfDump(K_PROF_PRINTF const printFn);
+#endif
+
 /*[EOF]*/
 
 #endif /* KAPI_H */
@@ -0,0 +1,129 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  In this header:
+ *                  o Private API: exclusive load/store primitives
+ *                  o Private API: atomic add
+ *
+ *****************************************************************************
+ A word is updated without masking interrupts by pairing an exclusive
+ load with an exclusive store:
+
+    do
+    {
+        val = kLdrEx(&word);
+        if (slow path needed)
+        {
+            kClrEx();
+            ...
+        }
+    } while (!kStrEx(&word, val, newVal));
+
+ On ARMv7-M the local monitor is cleared on every exception entry and
+ return. On a single core the store fails whenever anything ran between
+ the pair, so plain reads done in between are consistent with the word.
+
+ Host builds (no LDREX/STREX) fall back to C11 memory-model atomics: the
+ exclusive store is a compare-and-swap against the value the caller
+ loaded, which is why kStrEx takes it. The target ignores it.
+ ******************************************************************************/
+
+#ifndef KATOMIC_H
+#define KATOMIC_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "ktypes.h"
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+
+__attribute__((always_inline)) static inline UINT32 kLdrEx(
+        UINT32 volatile* const addr)
+{
+    UINT32 val;
+    asm volatile ("ldrex %0, [%1]" : "=r"(val) : "r"(addr) : "memory");
+    return (val);
+}
+
+/* TRUE if the store took place */
+__attribute__((always_inline)) static inline BOOL kStrEx(
+        UINT32 volatile* const addr, UINT32 const old, UINT32 const val)
+{
+    (VOID) old;
+    UINT32 fail;
+    asm volatile ("strex %0, %2, [%1]" : "=&r"(fail) : "r"(addr), "r"(val)
+            : "memory");
+    return ((fail == 0U) ? TRUE : FALSE);
+}
+
+__attribute__((always_inline)) static inline VOID kClrEx(VOID)
+{
+    asm volatile ("clrex" ::: "memory");
+}
+
+/* pointers are words on this target */
+#define K_LDREX_PTR(pp)      ((ADDR) kLdrEx((UINT32 volatile*) (pp)))
+#define K_STREX_PTR(pp, o, v) \
+        kStrEx((UINT32 volatile*) (pp), (UINT32) (o), (UINT32) (v))
+
+#else /* host */
+
+__attribute__((always_inline)) static inline UINT32 kLdrEx(
+        UINT32 volatile* const addr)
+{
+    return (__atomic_load_n(addr, __ATOMIC_ACQUIRE));
+}
+
+__attribute__((always_inline)) static inline BOOL kStrEx(
+        UINT32 volatile* const addr, UINT32 const old, UINT32 const val)
+{
+    UINT32 expected = old;
+    return (__atomic_compare_exchange_n(addr, &expected, val, FALSE,
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+
+__attribute__((always_inline)) static inline VOID kClrEx(VOID)
+{
+}
+
+__attribute__((always_inline)) static inline ADDR kLdrExPtr_(
+        ADDR volatile* const addr)
+{
+    return (__atomic_load_n(addr, __ATOMIC_ACQUIRE));
+}
+
+__attribute__((always_inline)) static inline BOOL kStrExPtr_(
+        ADDR volatile* const addr, ADDR const old, ADDR const val)
+{
+    ADDR expected = old;
+    return (__atomic_compare_exchange_n(addr, &expected, val, FALSE,
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+
+#define K_LDREX_PTR(pp)      kLdrExPtr_((ADDR volatile*) (pp))
+#define K_STREX_PTR(pp, o, v) \
+        kStrExPtr_((ADDR volatile*) (pp), (ADDR) (o), (ADDR) (v))
+
+#endif
+
+/* adds delta to a word without masking interrupts; returns the new value */
+__attribute__((always_inline)) static inline UINT32 kAtomicAdd(
+        UINT32 volatile* const addr, INT32 const delta)
+{
+    UINT32 old;
+    UINT32 val;
+    do
+    {
+        old = kLdrEx(addr);
+        val = old + (UINT32) delta;
+    } while (!kStrEx(addr, old, val));
+    return (val);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* KATOMIC_H */
@@ -21,6 +21,12 @@
  *   Users can define it, as they wish, by configuring SysTick.
  *   Recommended value is 5ms.
  *
+ * - **Mutex Priority Ceiling:** (`K_DEF_MUTEX_PRIO_CEIL`)
+ *   Mutexes initialised with `kMutexInitCeil` raise their owner to the
+ *   configured ceiling as soon as the lock is taken (Immediate Priority
+ *   Ceiling Protocol). Mutexes initialised with `kMutexInit` keep using
+ *   priority inheritance.
+ *
  * - **Queue Discipline**: blocking mechanisms that can change the queue dis
  *   cipline are either by priority  (`K_DEF_ENQ_PRIO`) or FIFO (`K_DEF_ENQ_FIFO`).
  *   Default/fallback value is by priority.
@@ -87,8 +93,25 @@
 #if (K_DEF_MUTEX==ON)
 /* Queue Discipline:				 */
 #define K_DEF_MUTEX_ENQ				    (K_DEF_ENQ_PRIO)
+
+/* Immediate Priority Ceiling Protocol (kMutexInitCeil) */
+#define K_DEF_MUTEX_PRIO_CEIL           (ON)
 #endif
 
+/**/
+/*** [ Uncontended Fast Paths (Semaphores/Mutexes) ] **************************/
+/* Uncontended wait/signal and lock/unlock update the counter or the owner  */
+/* with exclusive load/store, without masking interrupts. The kernel is     */
+/* entered only to block or to wake a task.                                 */
+/* With K_DEF_SEMA_PRIOINV, semaphore waits keep the critical region.       */
+#define K_DEF_SYNCH_FASTPATH            (ON)
+
+/**/
+/*** [ Task Notifications ] ***************************************************/
+/* A 32-bit value on each TCB, sent with kNotify/kNotifyFromISR and taken */
+/* with kNotifyWait                                                        */
+#define K_DEF_TASK_NOTIFY                (ON)
+
 /**/
 /*** [ Sleep/Wake Events ] ****************************************************/
 #define K_DEF_SLEEPWAKE                  (OFF)
@@ -103,7 +126,8 @@
 #define SINGLE					 		 (1)
 #define MULTI					  		 (2)
 
-/* Multi-mail or single-mailbox */
+/* Multi-mail or single-mailbox.
+ * A multi-mail box is a ring of pointers; its capacity is a power of two. */
 #define K_DEF_MBOX_CAPACITY			    (MULTI)
 
 /* Queue discipline:   				 */
@@ -124,8 +148,165 @@
 /* Queue Discipline				 */
 #define K_DEF_MESGQ_ENQ				    (K_DEF_ENQ_PRIO)
 
+/* Overwrite-oldest (lossy) mode. A queue set to overwrite never blocks
+ * senders: a message sent to a full queue replaces the oldest one. */
+#define K_DEF_MESGQ_OVERWRITE		    (ON)
+
+/* Priority message queue: receive returns the highest-priority message */
+#define K_DEF_PMESGQ				    (ON)
+
 #endif /*mesgq*/
 
+/**/
+/*** [ Queue Watermarks ] *****************************************************/
+/* High/low fill watermarks and statistics on message queues and multi-item
+ * mailboxes */
+#define K_DEF_QWATERMARK                (ON)
+
+/**/
+/*** [ Broadcast Ring ] *******************************************************/
+/* One writer, N readers with their own cursors over a single ring */
+#define K_DEF_BCAST                     (ON)
+
+/**/
+/*** [ Snapshot Channel ] *****************************************************/
+/* Latest-value channel: non-blocking writer, lock-free torn-free readers */
+#define K_DEF_SNAP                      (ON)
+
+/**/
+/*** [ Shared Buffers ] *******************************************************/
+/* Reference-counted K_MEM blocks that can be passed through any queue */
+#define K_DEF_SHBUF                     (ON)
+
+/**/
+/*** [ Publish/Subscribe Bus ] ************************************************/
+/* Topics with zero-copy, reference-counted messages from a block pool */
+#define K_DEF_BUS                       (ON)
+
+/**/
+/*** [ Rendezvous ] ***********************************************************/
+/* Synchronous send-receive-reply between client and server tasks */
+#define K_DEF_RDV                       (ON)
+
+/**/
+/*** [ Kernel Statistics ] ****************************************************/
+/* A versioned statistics block (kStats) refreshed by kStatsUpdate, that a
+ * debugger can read while the core runs, and a monitor task (kStatsTask)
+ * printing a per-task view */
+#define K_DEF_STATS                     (OFF)
+
+#if (K_DEF_STATS==ON)
+/* Queues and pools registered with kStatsRegister */
+#define K_DEF_STATS_NOBJS               (4)
+/* Ticks between two refreshes of kStatsTask */
+#define K_DEF_STATS_PERIOD              (200)
+/* kStatsTask prints through the kLog ring when K_DEF_LOG is ON in text
+ * mode, holding one period of lines (96 bytes each). Otherwise its default
+ * output is _write, which blocks; see kStatsSetOutput */
+#endif
+
+/**/
+/*** [ CPU Load ] *************************************************************/
+/* The idle task times its sleep; the load is sampled every second and
+ * averaged over three windows (kCpuLoadGet) */
+#define K_DEF_CPULOAD                   (OFF)
+
+#if (K_DEF_CPULOAD==ON)
+/* Windows, in seconds */
+#define K_DEF_CPULOAD_WIN_SHORT         (1)
+#define K_DEF_CPULOAD_WIN_MID           (10)
+#define K_DEF_CPULOAD_WIN_LONG          (60)
+#endif
+
+/**/
+/*** [ Stack Monitor ] ********************************************************/
+/* Stack high-water marks, measured by the idle task on the stack paint,
+ * and a stack sentinel check on every context switch */
+#define K_DEF_STACKMON                  (OFF)
+
+#if (K_DEF_STACKMON==ON)
+/* Stack words the idle task reads on each pass */
+#define K_DEF_STACKMON_SCAN             (8)
+#endif
+
+/**/
+/*** [ Contention Profiler ] **************************************************/
+/* Blocking waits, time blocked and time-outs on semaphores, mutexes,
+ * mailboxes and message queues, per object and per task */
+#define K_DEF_CONTENTION                (OFF)
+
+#if (K_DEF_CONTENTION==ON)
+/* Objects tracked per task; waits on further objects are summed apart */
+#define K_DEF_CONTENTION_SLOTS          (4)
+#endif
+
+/**/
+/*** [ Wake-up Latency ] ******************************************************/
+/* Per-task cycles from a wake request (ISR or task) to the task being
+ * switched in: min/max/mean and a log2 histogram (kLatencyGet) */
+#define K_DEF_LATENCY                   (OFF)
+
+/**/
+/*** [ Service Profiling ] ****************************************************/
+/* Cycle cost of every kapi.h service called by the application, and the
+ * longest interrupt-masked window (see kprof.h) */
+#define K_DEF_PROFILE                   (OFF)
+
+/**/
+/*** [ Deferred Logging ] *****************************************************/
+/* kLog stores a format string address and up to 4 word arguments on a
+ * lock-free ring; kLogTask formats and outputs them at low priority */
+#define K_DEF_LOG                       (OFF)
+
+#if (K_DEF_LOG==ON)
+/* Number of records (32 bytes each). Must be a power of two */
+#define K_DEF_LOG_DEPTH                 (64)
+/* ON: raw records, decoded on the host by tools/klog.py. OFF: text */
+#define K_DEF_LOG_BINARY                (OFF)
+/* Ticks between two drains of kLogTask */
+#define K_DEF_LOG_PERIOD                (10)
+#endif
+
+/**/
+/*** [ PC Sampling Profiler ] *************************************************/
+/* Counts of the interrupted PC, per task and per address range, on a hash
+ * table dumped to the host (tools/kpcprof.py) */
+#define K_DEF_PCSAMPLE                  (OFF)
+
+#if (K_DEF_PCSAMPLE==ON)
+/* Sample on every tick. OFF: the application calls kPcSampleISR from the
+ * interrupt of a faster timer */
+#define K_DEF_PCSAMPLE_TICK             (ON)
+/* Hash table slots (8 bytes each). Must be a power of two */
+#define K_DEF_PCSAMPLE_SLOTS            (256)
+/* Address range counted by a slot: 2^K_DEF_PCSAMPLE_SHIFT bytes */
+#define K_DEF_PCSAMPLE_SHIFT            (4)
+#endif
+
+/**/
+/*** [ Trace Recorder ] *******************************************************/
+/* Kernel events with cycle stamps on a RAM ring (see ktrace.h) */
+#define K_DEF_TRACE                     (OFF)
+
+#if (K_DEF_TRACE==ON)
+/* Number of records (12 bytes each). Must be a power of two */
+#define K_DEF_TRACE_DEPTH               (256)
+#endif
+
+/**/
+/*** [ Crash Dump ] ***********************************************************/
+/* kErrHandler and kFaultEntry save the fault state to a .noinit section,
+ * read back on the next boot with kCrashDumpGet. The linker script must
+ * place .noinit in a NOLOAD RAM region */
+#define K_DEF_CRASHDUMP                 (OFF)
+
+#if (K_DEF_CRASHDUMP==ON)
+/* Reset once the state is saved. OFF: halt for a debugger */
+#define K_DEF_CRASHDUMP_RESET           (ON)
+/* Last trace records saved (with K_DEF_TRACE) */
+#define K_DEF_CRASHDUMP_NTRACE          (16)
+#endif
+
 /**/
 /*** [ Pump-Drop Queues ] *****************************************************/
 #define K_DEF_PDQ                       (OFF)
@@ -17,6 +17,10 @@ extern "C" {
 extern volatile K_FAULT faultID;
 VOID ITM_SendValue(UINT32);
 VOID kErrHandler(K_FAULT);
+#if (K_DEF_CRASHDUMP==ON)
+VOID kCrashCapture(K_FAULT const, UINT32 const *const, UINT32 const);
+VOID kFaultEntry(VOID);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -122,7 +122,7 @@ __STATIC_FORCEINLINE unsigned kIsISR()
 #define K_EXIT_CR  kExitCR(crState_);
 #define K_PEND_CTXTSWTCH K_TRAP_PENDSV
 #define K_SWTCH			 _K_SWTCH
-#define READY_HIGHER_PRIO(ptr) ((ptr->priority < nextTaskPrio) ? 1 : 0)
+#define READY_HIGHER_PRIO(ptr) ((ptr->priority < runPtr->priority) ? 1 : 0)
 #define K_TICK_TYPE_MAX ((1ULL << (8 * sizeof(typeof(TICK)))) - 1)
 #define K_PRIO_TYPE_MAX ((1ULL << (8 * sizeof(typeof(PRIO)))) - 1)
 #define IS_NULL_PTR(ptr) ((ptr) == NULL ? 1 : 0)
@@ -138,6 +138,13 @@ __STATIC_FORCEINLINE unsigned kIsISR()
 
 #define K_TICK_EN  SysTick->CTRL |= 0xFFFFFFFF;
 #define K_TICK_DIS SysTick->CTRL &= 0xFFFFFFFE;
+
+/* DWT cycle counter: free-running at the core clock once enabled */
+#define K_CYCLE_CNT_EN \
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; \
+    DWT->CYCCNT = 0; \
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#define K_CYCLE_CNT (DWT->CYCCNT)
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
 #define IS_INIT(obj) (obj)->init) ? (1) : (0)
@@ -146,6 +153,7 @@ __STATIC_FORCEINLINE unsigned kIsISR()
 #define ONESHOT    		    0
 #define K_WAIT_FOREVER      (0xFFFFFFFF)
 #define K_NO_WAIT			(0)
+#define K_MUTEX_NO_CEIL     (0xFF)
 #define DEADCODE (0)
 
 #ifdef __cplusplus
@@ -27,7 +27,18 @@ extern "C" {
 K_ERR kPend(VOID);
 K_ERR kSignal(TID const);
 
+#if (K_DEF_TASK_NOTIFY==ON)
 
+K_ERR kNotifyFromISR(TID const, UINT32 const, K_NOTIFY_ACTION const);
+
+#endif
+
+
+#if (K_DEF_RDV==ON)
+
+VOID kRdvServerPrio(K_RDV* const, K_TCB* const);
+
+#endif
 
 #if (K_DEF_SLEEPWAKE==ON)
 
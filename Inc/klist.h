@@ -196,6 +196,7 @@ K_ERR kTCBQEnq(K_LIST* const, K_TCB* const);
 K_ERR kTCBQDeq(K_TCBQ* const, K_TCB** const);
 K_ERR kTCBQRem(K_TCBQ* const, K_TCB** const);
 K_ERR kReadyCtxtSwtch(K_TCB* const);
+UINT32 kReadyAllCtxtSwtch(K_TCBQ* const);
 K_ERR kReadyQDeq(K_TCB** const, PRIO);
 K_TCB* kTCBQPeek(K_TCBQ* const);
 K_ERR kTCBQEnqByPrio(K_TCBQ* const, K_TCB* const);
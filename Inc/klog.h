@@ -0,0 +1,35 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  In this header:
+ *                  o Private API: deferred logging ring
+ *
+ *****************************************************************************/
+
+#ifndef KLOG_H
+#define KLOG_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "kconfig.h"
+#include "ktypes.h"
+#include "kobjs.h"
+
+#if (K_DEF_LOG==ON)
+
+extern K_LOG_BUF kLogBuf;
+
+VOID kLogInit(VOID);
+K_ERR kLogWrite(STRING const fmt, BYTE const nArgs, UINT32 const arg0,
+		UINT32 const arg1, UINT32 const arg2, UINT32 const arg3);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* KLOG_H */
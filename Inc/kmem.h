@@ -8,6 +8,11 @@ extern "C" {
 K_ERR kMemInit(K_MEM* const, ADDR const, BYTE const, BYTE);
 ADDR kMemAlloc(K_MEM* const);
 K_ERR kMemFree(K_MEM* const, ADDR const);
+#if (K_DEF_SHBUF==ON)
+K_SHBUF* kShBufAlloc(K_MEM* const);
+K_ERR kShBufRetain(K_SHBUF* const);
+K_ERR kShBufRelease(K_SHBUF* const);
+#endif
 
 #ifdef __cplusplus
 }
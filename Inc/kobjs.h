@@ -32,12 +32,37 @@ typedef enum
 #if (K_DEF_MESGQ==ON)
     MESGQUEUE,
 #endif
+#if (K_DEF_PMESGQ==ON)
+    PMESGQUEUE,
+#endif
 #if(K_DEF_SLEEPWAKE==ON)
 	EVENT,
+#endif
+#if (K_DEF_TASK_NOTIFY==ON)
+	TASKNOTIFY,
+#endif
+#if (K_DEF_BCAST==ON)
+	BCASTREADER,
+	BCASTWRITER,
+#endif
+#if (K_DEF_BUS==ON)
+	BUSSUB,
+#endif
+#if (K_DEF_RDV==ON)
+	RDVCALLER,
+	RDVSERVER,
 #endif
     NONE
 } K_OBJ_SYNCH;
 
+typedef struct kTimeoutNode
+{
+    struct kTimeoutNode *nextPtr;
+    TICK timeout;
+    ADDR kobj;
+    K_OBJ_SYNCH objectType;
+} K_TIMEOUT_NODE;
+
 
 struct kListNode
 {
@@ -54,6 +79,113 @@ struct kList
 };
 
 
+#if (K_DEF_STATS==ON)
+
+#define K_STATS_VERSION (1)
+
+/* Task entry of the statistics block: eight words */
+struct kStatsTask
+{
+    UINT32 runCycles;               /* cycles run in the last period */
+    UINT32 runCnt;
+    UINT32 nPreempted;
+    UINT32 lostSignals;
+    UINT32 stackSize;               /* words */
+    UINT32 stackUsed;               /* words, with K_DEF_STACKMON */
+    PID    pid;
+    TID    tid;
+    BYTE   status;                  /* K_TASK_STATUS */
+    PRIO   priority;
+    PRIO   realPrio;
+    PID    preemptedBy;
+    UINT16 cpu;                     /* permille of the last period */
+};
+
+/* Registered queue or pool: six words */
+struct kStatsObjEntry
+{
+    UINT32 kobj;
+    UINT32 name;                    /* STRING */
+    UINT32 type;                    /* K_STATS_OBJ */
+    UINT32 used;
+    UINT32 capacity;
+    UINT32 events;
+};
+
+/* Statistics block. Fixed layout for a given K_STATS_VERSION; readers
+ * retry while seq is odd or changed during the read */
+struct kStats
+{
+    UINT32 magic;
+    UINT32 version;
+    UINT32 size;                    /* sizeof(struct kStats) */
+    UINT32 volatile seq;
+    UINT32 tick;
+    UINT32 cpuHz;
+    UINT32 periodCycles;            /* cycles since the previous update */
+    UINT32 load;                    /* permille of the last period */
+    UINT32 nTasks;
+    UINT32 nObjs;
+    struct kStatsTask tasks[NTHREADS];
+    struct kStatsObjEntry objs[K_DEF_STATS_NOBJS];
+};
+
+#endif
+
+#if (K_DEF_CPULOAD==ON)
+
+/* CPU load, in permille, over the K_DEF_CPULOAD_WIN_* windows */
+struct kCpuLoad
+{
+    UINT16 loadShort;
+    UINT16 loadMid;
+    UINT16 loadLong;
+    UINT16 peak;                    /* highest one-second load */
+    UINT32 nSamples;                /* seconds measured */
+};
+
+#endif
+
+#if (K_DEF_CONTENTION==ON)
+
+/* Blocking waits on an object. Times are in cycles */
+struct kContention
+{
+    UINT32 nBlocked;
+    UINT32 nTimeouts;
+    UINT32 maxCycles;
+    UINT64 totalCycles;
+    PID    maxHolder;               /* owner during the longest wait */
+};
+
+/* Time a task spent blocked on one object */
+struct kContentionSlot
+{
+    ADDR   kobj;                    /* NULL: free slot */
+    UINT32 nBlocked;
+    UINT64 cycles;
+};
+
+#endif
+
+#if (K_DEF_LATENCY==ON)
+
+#define K_LATENCY_NBUCKETS (16)
+
+/* Wake-up latency in cycles. hist[i] counts latencies in [2^i, 2^(i+1)),
+ * the last bucket everything above */
+struct kLatency
+{
+    UINT32 count;
+    UINT32 min;
+    UINT32 max;
+    UINT32 mean;                    /* filled by kLatencyGet */
+    UINT64 sum;
+    UINT32 hist[K_LATENCY_NBUCKETS];
+};
+
+#endif
+
 struct kTcb
 {
 /* Don't change */
@@ -70,6 +202,10 @@ struct kTcb
 	TID uPid;             /* User-defined   task ID */
 	PRIO priority;        /* Task priority (0-31) 32 is invalid */
 	PRIO realPrio;        /* Real priority (for prio inheritance) */
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	PRIO ceilPrio;        /* Floor set by the ceiling mutexes held */
+	K_MUTEX* ceilHeldPtr; /* Ceiling mutexes held, most recent first */
+#endif
 
 #if (K_DEF_SCH_TSLICE == ON)
 	TICK timeSlice;
@@ -97,10 +233,48 @@ struct kTcb
 
 #if (K_DEF_MBOX==ON)
 	K_MBOX* pendingMbox;
+#endif
+#if ((K_DEF_MBOX==ON) || (K_DEF_MESGQ==ON) || (K_DEF_RDV==ON))
+	ADDR   mesgBufPtr;    /* message/buffer while blocked; NULL when served */
+	BOOL   mesgJam;       /* blocked sender posts on the queue head */
+	SIZE   mesgNFrags;    /* mesgBufPtr is a K_MESG_FRAG array if not 0 */
+#endif
+#if (K_DEF_PMESGQ==ON)
+	PRIO   mesgPrio;      /* priority of the message in transit */
 #endif
 	K_TIMER* pendingTmr;
 
+#if (K_DEF_TASK_NOTIFY==ON)
+	UINT32 notifyVal;
+	BOOL   notifyPend;    /* a value was sent and not taken yet */
+	BOOL   notifyWait;    /* pending on kNotifyWait */
+	K_TIMEOUT_NODE notifyTimeoutNode;
+#endif
+
 /* Monitoring */
+#if (K_DEF_STATS==ON)
+	UINT32 runCycles;     /* cycles run, free-running */
+#endif
+#if (K_DEF_STACKMON==ON)
+	UINT32 stackMaxUsed;  /* high-water mark, in words */
+#endif
+#if (K_DEF_CONTENTION==ON)
+	UINT32 blockStamp;    /* cycle count when it blocked */
+	ADDR   blockObj;
+	struct kContention* blockStatsPtr; /* NULL: not blocked on a tracked object */
+	UINT32* blockHolderPtr; /* per-owner cycles of a mutex */
+	PID    blockHolder;   /* owner when it blocked */
+	struct kContentionSlot blockedOn[K_DEF_CONTENTION_SLOTS];
+	UINT64 blockedOther;  /* cycles blocked on other objects */
+#endif
+#if (K_DEF_PROFILE==ON)
+	UINT32 maskMax;       /* longest masked window in the current service */
+#endif
+#if (K_DEF_LATENCY==ON)
+	UINT32 wakeStamp;     /* cycle count of the last wake request */
+	BOOL   wakeArmed;     /* woken, not switched in yet */
+	struct kLatency latency;
+#endif
 
 	BOOL   runToCompl;
     BOOL   yield;
@@ -121,14 +295,6 @@ struct kRunTime
 };
 extern struct kRunTime runTime;
 
-typedef struct kTimeoutNode
-{
-    struct kTimeoutNode *nextPtr;
-    TICK timeout;
-    ADDR kobj;
-    K_OBJ_SYNCH objectType;
-} K_TIMEOUT_NODE;
-
 
 #if (K_DEF_SEMA==ON)
 
@@ -141,6 +307,9 @@ struct kSema
 #endif
 	BOOL init;
 	K_TIMEOUT_NODE timeoutNode;
+#if (K_DEF_CONTENTION==ON)
+	struct kContention contention;
+#endif
 };
 
 #endif
@@ -150,10 +319,17 @@ struct kSema
 struct kMutex
 {
 	struct kList waitingQueue;
-	BOOL lock;
-	struct kTcb* ownerPtr;
+	struct kTcb* ownerPtr;  /* lock word: NULL when unlocked */
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	PRIO ceiling;       /* K_MUTEX_NO_CEIL: priority inheritance */
+	struct kMutex* nextHeldPtr; /* next ceiling mutex held by the owner */
+#endif
 	BOOL init;
 	K_TIMEOUT_NODE timeoutNode;
+#if (K_DEF_CONTENTION==ON)
+	struct kContention contention;
+	UINT32 holderCycles[NTHREADS]; /* waits per owner, by PID */
+#endif
 };
 #endif
 
@@ -185,6 +361,47 @@ struct kMemBlock
 	BOOL init;
 };
 
+#if (K_DEF_SHBUF==ON)
+/* Shared buffer: header of a pool block, the payload follows */
+struct kShBuf
+{
+	struct kMemBlock* memPtr;   /* pool the block returns to */
+	UINT32 volatile refCnt;
+	SIZE size;                  /* payload capacity in bytes */
+	BYTE data[];
+};
+#endif
+
+#if (K_DEF_QWATERMARK==ON)
+
+/* Queue fill statistics */
+struct kQStats
+{
+    SIZE   peakDepth;
+    TICK   timeAboveHigh;           /* ticks spent at or over the high mark */
+    UINT32 blockedSends;
+    UINT32 highCrossings;
+};
+
+/* Queue high/low watermarks */
+struct kQWatermark
+{
+    SIZE   high;                    /* 0: not set */
+    SIZE   low;
+    BOOL   above;                   /* high crossed, low not reached yet */
+    TICK   aboveSince;
+    K_QWM_CALLBACK callback;
+    ADDR   cbArgPtr;
+#if (K_DEF_TASK_NOTIFY==ON)
+    BOOL   notifyTask;
+    TID    notifyTID;
+    UINT32 highBits;                /* notification bits set on crossing */
+    UINT32 lowBits;
+#endif
+    struct kQStats stats;
+};
+
+#endif
 
 #if (K_DEF_MBOX==ON)
 
@@ -194,9 +411,12 @@ struct kMailbox
 {
     BOOL   init;
     ADDR   mailPtr;
-    struct kList waitingQueue;
+    struct kList sendersQueue;      /* writers blocked on full */
+    struct kList receiversQueue;    /* readers blocked on empty */
     K_TIMEOUT_NODE timeoutNode;
-
+#if (K_DEF_CONTENTION==ON)
+    struct kContention contention;
+#endif
 } __attribute__((aligned(4)));
 
 #elif (K_DEF_MBOX_CAPACITY==MULTI)
@@ -204,13 +424,19 @@ struct kMailbox
 struct kMailbox
 {
     BOOL init;
-    ADDR mailQPtr;
-    UINT headIdx;
-    UINT tailIdx;
-    SIZE maxItems;
-    SIZE countItems;
-    struct kList waitingQueue;
+    ADDR* mailQPtr;                 /* ring of mail pointers */
+    UINT32 headIdx;                 /* free-running read index */
+    UINT32 tailIdx;                 /* free-running write index */
+    SIZE mask;                      /* capacity - 1 (power of two) */
+    struct kList sendersQueue;      /* writers blocked on full */
+    struct kList receiversQueue;    /* readers blocked on empty */
     K_TIMEOUT_NODE timeoutNode;
+#if (K_DEF_QWATERMARK==ON)
+    struct kQWatermark watermark;
+#endif
+#if (K_DEF_CONTENTION==ON)
+    struct kContention contention;
+#endif
 } __attribute__((aligned(4)));
 
 #endif
@@ -231,12 +457,337 @@ struct kMesgQ
     ADDR buffer;
     SIZE  readIndex;
     SIZE  writeIndex;
-    struct kList waitingQueue;
+    struct kList sendersQueue;      /* senders blocked on full */
+    struct kList receiversQueue;    /* receivers blocked on empty */
 	K_TIMEOUT_NODE timeoutNode;
+#if (K_DEF_MESGQ_OVERWRITE==ON)
+    BOOL   overwrite;               /* full: replace the oldest message */
+    UINT32 dropCnt;                 /* messages overwritten unread */
+#endif
+#if (K_DEF_QWATERMARK==ON)
+    struct kQWatermark watermark;
+#endif
+#if (K_DEF_CONTENTION==ON)
+    struct kContention contention;
+#endif
+} __attribute__((aligned(4)));
+
+#if (K_DEF_PMESGQ==ON)
+
+/* Priority Message Queue heap node */
+struct kPMesgQNode
+{
+    UINT32 seq;                     /* arrival order among equal priorities */
+    UINT16 slot;                    /* message slot in the buffer */
+    PRIO   prio;
+};
+
+struct kPMesgQ
+{
+    BOOL init;
+    BYTE* buffer;
+    K_PMESGQ_NODE* heap;            /* maxMesg nodes; [0, mesgCnt) is the heap */
+    SIZE mesgSize;
+    SIZE maxMesg;
+    SIZE mesgCnt;
+    UINT32 seq;
+    struct kList sendersQueue;
+    struct kList receiversQueue;
 } __attribute__((aligned(4)));
 
+/* A blocked sender or receiver: lives on its stack while it waits */
+struct kPMesgQWait
+{
+    ADDR bufPtr;                    /* message to send, or receive buffer */
+    struct kPMesgQ* queuePtr;
+    struct kTcb* tcbPtr;
+    K_TIMEOUT_NODE timeoutNode;     /* this waiter time-out */
+};
+
+#endif
+
 #endif /*K_DEF_MSG_QUEUE*/
 
+#if (K_DEF_BCAST==ON)
+
+/* Broadcast ring reader cursor */
+struct kBcastReader
+{
+    struct kBcastReader* nextPtr;   /* next registered reader */
+    struct kBcast* ringPtr;
+    UINT32 seq;                     /* next sequence to read */
+    UINT32 lost;                    /* messages skipped when lapped */
+    K_TCB* waitingPtr;              /* task blocked on this cursor */
+    K_TIMEOUT_NODE timeoutNode;
+};
+
+/* Broadcast ring */
+struct kBcast
+{
+    BOOL init;
+    BYTE* buffer;
+    SIZE mesgSize;
+    UINT32 mask;                    /* capacity - 1 (power of two) */
+    UINT32 writeSeq;                /* next sequence to be written */
+    K_BCAST_POLICY policy;
+    struct kBcastReader* readersPtr;
+    struct kList readersQueue;      /* readers with nothing new */
+    struct kList writerQueue;       /* writer blocked on the slowest reader */
+    K_TIMEOUT_NODE timeoutNode;     /* writer time-out */
+} __attribute__((aligned(4)));
+
+#endif
+
+#if (K_DEF_SNAP==ON)
+
+/* Snapshot channel: three buffers of mesgSize bytes */
+struct kSnap
+{
+    BOOL init;
+    BYTE* buffer;
+    SIZE mesgSize;
+    UINT32 volatile version;        /* 0: never written */
+    UINT32 volatile writing;        /* a write is in progress */
+} __attribute__((aligned(4)));
+
+#endif
+
+#if (K_DEF_BUS==ON)
+
+/* Bus message: header of a pool block, the payload follows */
+struct kBusMsg
+{
+    struct kBusTopic* topicPtr;
+    UINT32 volatile refCnt;         /* publisher + subscribers holding it */
+    TICK   stamp;                   /* publish tick */
+    SIZE   size;                    /* payload capacity in bytes */
+    BYTE   data[];
+};
+
+struct kBusStats
+{
+    UINT32 nPublished;
+    UINT32 nAllocFail;              /* publishes with no free block */
+    UINT32 nDropped;                /* deliveries lost on full subscribers */
+    TICK   lastPubTick;
+    TICK   minInterval;             /* ticks between publishes */
+    TICK   maxInterval;
+    UINT32 maxLag;                  /* deepest subscriber backlog */
+};
+
+/* Bus subscriber: a ring of pending messages or a callback */
+struct kBusSub
+{
+    struct kBusSub* nextPtr;
+    struct kBusTopic* topicPtr;
+    K_BUS_CALLBACK callback;        /* NULL for a queued subscriber */
+    ADDR   cbArgPtr;
+    K_BUS_MSG** ringPtr;
+    UINT32 mask;                    /* ring depth - 1 (power of two) */
+    UINT32 headIdx;
+    UINT32 tailIdx;
+    K_TCB* waitingPtr;              /* task blocked on an empty ring */
+    K_TIMEOUT_NODE timeoutNode;
+    UINT32 nDropped;
+    UINT32 maxLag;
+};
+
+/* Bus topic */
+struct kBusTopic
+{
+    STRING name;
+    struct kMemBlock* memPtr;       /* message pool */
+    struct kBusSub* subsPtr;
+    struct kList waitingQueue;      /* queued subscribers blocked on empty */
+    struct kBusStats stats;
+    BOOL init;
+} __attribute__((aligned(4)));
+
+#endif
+
+#if (K_DEF_RDV==ON)
+
+/* A call in transit: lives on the client stack while it is blocked */
+struct kRdvCall
+{
+    ADDR reqPtr;
+    ADDR replyPtr;
+    struct kRdv* rdvPtr;
+    struct kTcb* tcbPtr;            /* client */
+    K_TIMEOUT_NODE timeoutNode;     /* client time-out, until accepted */
+};
+
+/* Rendezvous: clients call, one server accepts and replies */
+struct kRdv
+{
+    BOOL init;
+    struct kList callersQueue;      /* clients not accepted yet */
+    struct kTcb* serverPtr;         /* server blocked on accept */
+    struct kTcb* ownerPtr;          /* server handling a call */
+    struct kTcb* clientPtr;         /* client waiting for the reply */
+    PRIO savedPrio;                 /* server priority before inheriting */
+    PRIO boostPrio;                 /* server priority last set by the call */
+    K_TIMEOUT_NODE timeoutNode;     /* server time-out on accept */
+} __attribute__((aligned(4)));
+
+#endif
+
+#if (K_DEF_PROFILE==ON)
+
+/* Service call in progress, on the caller stack */
+struct kProfCtx
+{
+    UINT32 stamp;                   /* cycle count on entry */
+    UINT32 runCnt;                  /* caller runCnt on entry */
+    UINT32 maskMax;                 /* caller maskMax on entry */
+};
+
+/* Service statistics, in cycles. Calls the caller was switched out of
+ * (blocked or preempted) are only counted in nSwitched */
+struct kProfStat
+{
+    UINT32 count;
+    UINT32 nSwitched;
+    UINT32 min;
+    UINT32 max;
+    UINT64 total;
+    UINT32 maskMax;                 /* longest masked window in a call */
+};
+
+#endif
+
+#if (K_DEF_LOG==ON)
+
+#define K_LOG_NARGS (4)
+#define K_LOG_PID_ISR (0xFF)
+
+/* Log record: eight words */
+struct kLogRec
+{
+    UINT32 volatile seq;            /* ring index + 1 once complete */
+    UINT32 stamp;                   /* cycle counter */
+    STRING fmt;                     /* format string, never copied */
+    UINT32 args[K_LOG_NARGS];
+    PID    pid;                     /* K_LOG_PID_ISR from an interrupt */
+    BYTE   nArgs;
+    UINT16 reserved;
+};
+
+/* Log ring: many writers, the log task as the only reader */
+struct kLogBuf
+{
+    UINT32 volatile head;           /* records claimed since start */
+    UINT32 volatile tail;           /* records taken off the ring */
+    UINT32 volatile done;           /* records output (outputFn returned) */
+    UINT32 volatile overruns;       /* records lost on a full ring */
+    UINT32 reported;                /* overruns already output */
+    K_LOG_OUTPUT outputFn;
+    struct kLogRec rec[K_DEF_LOG_DEPTH];
+};
+
+#endif
+
+#if (K_DEF_PCSAMPLE==ON)
+
+/* PC samples of a task in an address range: two words */
+struct kPcSampleSlot
+{
+    UINT32 addr;                    /* range base; 0: free slot */
+    UINT16 count;                   /* saturates at 0xFFFF */
+    PID    pid;
+    BYTE   reserved;
+};
+
+/* Sample table, dumped as is to the host */
+struct kPcSampleBuf
+{
+    UINT32 magic;
+    UINT32 nSlots;
+    UINT32 shift;                   /* range of a slot: 2^shift bytes */
+    UINT32 nTasks;
+    UINT32 volatile on;
+    UINT32 nSamples;
+    UINT32 nHandler;                /* samples of an interrupted handler */
+    UINT32 nDropped;                /* no free slot found */
+    UINT32 taskSamples[NTHREADS];   /* by PID */
+    struct kPcSampleSlot slot[K_DEF_PCSAMPLE_SLOTS];
+};
+
+#endif
+
+#if (K_DEF_TRACE==ON)
+
+/* Trace record: three words */
+struct kTraceRec
+{
+    UINT32 stamp;                   /* cycle counter */
+    BYTE   evt;                     /* K_TRACE_EVT */
+    PID    pid;
+    UINT16 arg;
+    UINT32 obj;                     /* object address */
+};
+
+/* Trace ring, dumped as is to the host */
+struct kTraceBuf
+{
+    UINT32 magic;
+    UINT32 depth;                   /* records, power of two */
+    UINT32 cpuHz;                   /* cycle counter frequency */
+    UINT32 volatile head;           /* records written since start */
+    UINT32 volatile on;
+    struct kTraceRec rec[K_DEF_TRACE_DEPTH];
+};
+
+#endif
+
+#if (K_DEF_CRASHDUMP==ON)
+
+/* Task state at the crash: four words */
+struct kCrashTask
+{
+    UINT32 sp;                      /* saved stack pointer */
+    UINT32 stackAddr;
+    UINT32 stackSize;               /* words */
+    PID    pid;
+    TID    tid;
+    BYTE   status;                  /* K_TASK_STATUS */
+    PRIO   priority;
+};
+
+/* Crash record, kept across a reset. Words up to tasks[] have a fixed
+ * layout (tools/kcrash.py) */
+struct kCrashDump
+{
+    UINT32 magic;
+    UINT32 size;                    /* sizeof(struct kCrashDump) */
+    UINT32 checksum;
+    UINT32 pending;                 /* not cleared by kCrashDumpClear yet */
+    UINT32 nCrashes;                /* captures since the record was valid */
+    UINT32 fault;                   /* K_FAULT */
+    UINT32 tick;
+    UINT32 hasFrame;                /* regs hold an exception frame */
+    UINT32 regs[8];                 /* r0-r3, r12, lr, pc, xpsr */
+    UINT32 lr;                      /* EXC_RETURN, or kErrHandler caller */
+    UINT32 msp;
+    UINT32 psp;
+    UINT32 ipsr;
+    UINT32 cfsr;
+    UINT32 hfsr;
+    UINT32 mmfar;
+    UINT32 bfar;
+    UINT32 runPtr;
+    UINT32 readyMask;               /* non-empty ready queues */
+    UINT32 nTasks;
+    UINT32 nTrace;                  /* trace records saved */
+    struct kCrashTask tasks[NTHREADS];
+#if (K_DEF_TRACE==ON)
+    struct kTraceRec trace[K_DEF_CRASHDUMP_NTRACE]; /* oldest first */
+#endif
+    struct kTcb runTcb;             /* raw copy, for the debugger */
+};
+
+#endif
+
 #if (K_DEF_PDQ== ON)
 
 struct kPumpDropBuf
@@ -0,0 +1,34 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  In this header:
+ *                  o Private API: PC sampling profiler
+ *
+ *****************************************************************************/
+
+#ifndef KPCSAMPLE_H
+#define KPCSAMPLE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "kconfig.h"
+#include "ktypes.h"
+#include "kobjs.h"
+
+#if (K_DEF_PCSAMPLE==ON)
+
+extern K_PCSAMPLE_BUF kPcSample;
+
+VOID kPcSampleInit(VOID);
+VOID kPcSampleISR(VOID);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* KPCSAMPLE_H */
@@ -0,0 +1,349 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  In this header:
+ *                  o Service profiling: service table and call wrappers
+ *
+ *****************************************************************************
+ With K_DEF_PROFILE, kapi.h includes this header and every public service
+ called by the application goes through a wrapper that stamps the cycle
+ counter on entry and exit:
+
+    err = kSemaWait(&sema, 10);
+
+ expands to a call of kSemaWait bracketed by kProfEnter/kProfExit. The
+ kernel itself does not include kapi.h, so calls between services are not
+ counted twice. Other kernel headers, if needed, go before kapi.h.
+ ******************************************************************************/
+
+#ifndef KPROF_H
+#define KPROF_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "kconfig.h"
+#include "ktypes.h"
+#include "kobjs.h"
+
+#if (K_DEF_PROFILE==ON)
+
+/* profiled services, grouped as in kapi.h */
+#define K_PROF_SVC_TASK(X) \
+	X(kCreateTask) X(kYield) X(kPend) X(kSignal) X(kSuspend) \
+	X(kGetTaskPID) X(kGetTaskPrio) X(kMemCpy)
+#define K_PROF_SVC_TIMER(X) \
+	X(kTimerInit) X(kBusyDelay) X(kSleep) X(kTickGet)
+#if (K_DEF_SCH_TSLICE==OFF)
+#define K_PROF_SVC_SLEEPUNTIL(X) \
+	X(kSleepUntil)
+#else
+#define K_PROF_SVC_SLEEPUNTIL(X)
+#endif
+#define K_PROF_SVC_MEM(X) \
+	X(kMemInit) X(kMemAlloc) X(kMemFree)
+#if (K_DEF_SHBUF==ON)
+#define K_PROF_SVC_SHBUF(X) \
+	X(kShBufAlloc) X(kShBufRetain) X(kShBufRelease)
+#else
+#define K_PROF_SVC_SHBUF(X)
+#endif
+#if (K_DEF_SEMA==ON)
+#define K_PROF_SVC_SEMA(X) \
+	X(kSemaInit) X(kSemaWait) X(kSemaSignal) X(kSemaQuery)
+#else
+#define K_PROF_SVC_SEMA(X)
+#endif
+#if (K_DEF_MUTEX==ON)
+#define K_PROF_SVC_MUTEX(X) \
+	X(kMutexInit) X(kMutexLock) X(kMutexUnlock) X(kMutexQuery)
+#else
+#define K_PROF_SVC_MUTEX(X)
+#endif
+#if ((K_DEF_MUTEX==ON) && (K_DEF_MUTEX_PRIO_CEIL==ON))
+#define K_PROF_SVC_MUTEX_CEIL(X) \
+	X(kMutexInitCeil)
+#else
+#define K_PROF_SVC_MUTEX_CEIL(X)
+#endif
+#if (K_DEF_TASK_NOTIFY==ON)
+#define K_PROF_SVC_NOTIFY(X) \
+	X(kNotify) X(kNotifyFromISR) X(kNotifyWait)
+#else
+#define K_PROF_SVC_NOTIFY(X)
+#endif
+#if (K_DEF_SLEEPWAKE==ON)
+#define K_PROF_SVC_EVENT(X) \
+	X(kEventInit) X(kEventSleep) X(kEventWake) X(kEventSignal) \
+	X(kEventQuery)
+#else
+#define K_PROF_SVC_EVENT(X)
+#endif
+#if (K_DEF_MBOX==ON)
+#define K_PROF_SVC_MBOX(X) \
+	X(kMboxInit) X(kMboxPost) X(kMboxPend) X(kMboxIsFull)
+#else
+#define K_PROF_SVC_MBOX(X)
+#endif
+#if ((K_DEF_MBOX==ON) && (K_DEF_MBOX_CAPACITY==SINGLE) && (K_DEF_MBOX_SENDRECV==ON))
+#define K_PROF_SVC_MBOX_SENDRECV(X) \
+	X(kMboxPostPend)
+#else
+#define K_PROF_SVC_MBOX_SENDRECV(X)
+#endif
+#if ((K_DEF_MBOX==ON) && (K_DEF_MBOX_CAPACITY==MULTI))
+#define K_PROF_SVC_MBOX_MULTI(X) \
+	X(kMboxTryPost) X(kMboxPostFromISR) X(kMboxTryPend) X(kMboxPeek) \
+	X(kMboxMailCount)
+#else
+#define K_PROF_SVC_MBOX_MULTI(X)
+#endif
+#if ((K_DEF_MBOX==ON) && (K_DEF_MBOX_CAPACITY==MULTI) && (K_DEF_QWATERMARK==ON))
+#define K_PROF_SVC_MBOX_QWM(X) \
+	X(kMboxSetWatermarks) X(kMboxGetQStats)
+#else
+#define K_PROF_SVC_MBOX_QWM(X)
+#endif
+#if ((K_DEF_MBOX==ON) && (K_DEF_MBOX_CAPACITY==MULTI) && (K_DEF_QWATERMARK==ON) \
+		&& (K_DEF_TASK_NOTIFY==ON))
+#define K_PROF_SVC_MBOX_QWM_NOTIFY(X) \
+	X(kMboxWatermarkNotify)
+#else
+#define K_PROF_SVC_MBOX_QWM_NOTIFY(X)
+#endif
+#if (K_DEF_MESGQ==ON)
+#define K_PROF_SVC_MESGQ(X) \
+	X(kMesgQInit) X(kMesgQGetMesgCount) X(kMesgQJam) X(kMesgQRecv) \
+	X(kMesgQSend) X(kMesgQSendV) X(kMesgQRecvV) X(kMesgQPeek)
+#else
+#define K_PROF_SVC_MESGQ(X)
+#endif
+#if ((K_DEF_MESGQ==ON) && (K_DEF_QWATERMARK==ON))
+#define K_PROF_SVC_MESGQ_QWM(X) \
+	X(kMesgQSetWatermarks) X(kMesgQGetQStats)
+#else
+#define K_PROF_SVC_MESGQ_QWM(X)
+#endif
+#if ((K_DEF_MESGQ==ON) && (K_DEF_QWATERMARK==ON) && (K_DEF_TASK_NOTIFY==ON))
+#define K_PROF_SVC_MESGQ_QWM_NOTIFY(X) \
+	X(kMesgQWatermarkNotify)
+#else
+#define K_PROF_SVC_MESGQ_QWM_NOTIFY(X)
+#endif
+#if ((K_DEF_MESGQ==ON) && (K_DEF_MESGQ_OVERWRITE==ON))
+#define K_PROF_SVC_MESGQ_OVERWRITE(X) \
+	X(kMesgQSetOverwrite) X(kMesgQGetDropCount)
+#else
+#define K_PROF_SVC_MESGQ_OVERWRITE(X)
+#endif
+#if ((K_DEF_MESGQ==ON) && (K_DEF_PMESGQ==ON))
+#define K_PROF_SVC_PMESGQ(X) \
+	X(kPMesgQInit) X(kPMesgQSend) X(kPMesgQRecv) X(kPMesgQGetMesgCount)
+#else
+#define K_PROF_SVC_PMESGQ(X)
+#endif
+#if (K_DEF_BCAST==ON)
+#define K_PROF_SVC_BCAST(X) \
+	X(kBcastInit) X(kBcastAttach) X(kBcastDetach) X(kBcastPublish) \
+	X(kBcastRead) X(kBcastAcquire) X(kBcastRelease) X(kBcastGetLost)
+#else
+#define K_PROF_SVC_BCAST(X)
+#endif
+#if (K_DEF_SNAP==ON)
+#define K_PROF_SVC_SNAP(X) \
+	X(kSnapInit) X(kSnapWrite) X(kSnapRead) X(kSnapVersion)
+#else
+#define K_PROF_SVC_SNAP(X)
+#endif
+#if (K_DEF_BUS==ON)
+#define K_PROF_SVC_BUS(X) \
+	X(kBusTopicInit) X(kBusSubscribe) X(kBusSubscribeCallback) \
+	X(kBusUnsubscribe) X(kBusAlloc) X(kBusPublish) X(kBusRecv) \
+	X(kBusRetain) X(kBusRelease) X(kBusGetStats)
+#else
+#define K_PROF_SVC_BUS(X)
+#endif
+#if (K_DEF_RDV==ON)
+#define K_PROF_SVC_RDV(X) \
+	X(kRdvInit) X(kRdvCall) X(kRdvAccept) X(kRdvReply)
+#else
+#define K_PROF_SVC_RDV(X)
+#endif
+#if (K_DEF_PDQ==ON)
+#define K_PROF_SVC_PDQ(X) \
+	X(kPDQInit) X(kPDQReserve) X(kPDQPump) X(kPDQFetch) X(kPDQDrop)
+#else
+#define K_PROF_SVC_PDQ(X)
+#endif
+
+#define K_PROF_SVCS(X) \
+	K_PROF_SVC_TASK(X) \
+	K_PROF_SVC_TIMER(X) \
+	K_PROF_SVC_SLEEPUNTIL(X) \
+	K_PROF_SVC_MEM(X) \
+	K_PROF_SVC_SHBUF(X) \
+	K_PROF_SVC_SEMA(X) \
+	K_PROF_SVC_MUTEX(X) \
+	K_PROF_SVC_MUTEX_CEIL(X) \
+	K_PROF_SVC_NOTIFY(X) \
+	K_PROF_SVC_EVENT(X) \
+	K_PROF_SVC_MBOX(X) \
+	K_PROF_SVC_MBOX_SENDRECV(X) \
+	K_PROF_SVC_MBOX_MULTI(X) \
+	K_PROF_SVC_MBOX_QWM(X) \
+	K_PROF_SVC_MBOX_QWM_NOTIFY(X) \
+	K_PROF_SVC_MESGQ(X) \
+	K_PROF_SVC_MESGQ_QWM(X) \
+	K_PROF_SVC_MESGQ_QWM_NOTIFY(X) \
+	K_PROF_SVC_MESGQ_OVERWRITE(X) \
+	K_PROF_SVC_PMESGQ(X) \
+	K_PROF_SVC_BCAST(X) \
+	K_PROF_SVC_SNAP(X) \
+	K_PROF_SVC_BUS(X) \
+	K_PROF_SVC_RDV(X) \
+	K_PROF_SVC_PDQ(X)
+
+#define K_PROF_ENUM_(fn) K_PROF_##fn,
+
+typedef enum kProfSvc
+{
+	K_PROF_SVCS(K_PROF_ENUM_)
+	K_PROF_NSVC
+} K_PROF_SVC;
+
+VOID kProfEnter(K_PROF_CTX *const);
+VOID kProfExit(K_PROF_SVC const, K_PROF_CTX *const);
+
+/* masked windows, from kEnterCR/kExitCR */
+extern UINT32 kProfMaskStamp;
+VOID kProfMaskEnd(ADDR const);
+
+#ifndef K_CODE
+
+#define K_PROF_R(fn, ...) \
+	({ \
+		K_PROF_CTX profCtx_; \
+		kProfEnter(&profCtx_); \
+		__typeof__(fn(__VA_ARGS__)) profRet_ = fn(__VA_ARGS__); \
+		kProfExit(K_PROF_##fn, &profCtx_); \
+		profRet_; \
+	})
+
+#define K_PROF_V(fn, ...) \
+	do \
+	{ \
+		K_PROF_CTX profCtx_; \
+		kProfEnter(&profCtx_); \
+		fn(__VA_ARGS__); \
+		kProfExit(K_PROF_##fn, &profCtx_); \
+	} while(0U)
+
+#define kCreateTask(...) K_PROF_R(kCreateTask, __VA_ARGS__)
+#define kYield(...) K_PROF_V(kYield, __VA_ARGS__)
+#define kPend(...) K_PROF_V(kPend, __VA_ARGS__)
+#define kSignal(...) K_PROF_R(kSignal, __VA_ARGS__)
+#define kSuspend(...) K_PROF_R(kSuspend, __VA_ARGS__)
+#define kGetTaskPID(...) K_PROF_R(kGetTaskPID, __VA_ARGS__)
+#define kGetTaskPrio(...) K_PROF_R(kGetTaskPrio, __VA_ARGS__)
+#define kMemCpy(...) K_PROF_R(kMemCpy, __VA_ARGS__)
+#define kTimerInit(...) K_PROF_R(kTimerInit, __VA_ARGS__)
+#define kBusyDelay(...) K_PROF_V(kBusyDelay, __VA_ARGS__)
+#define kSleep(...) K_PROF_V(kSleep, __VA_ARGS__)
+#define kTickGet(...) K_PROF_R(kTickGet, __VA_ARGS__)
+#define kSleepUntil(...) K_PROF_V(kSleepUntil, __VA_ARGS__)
+#define kMemInit(...) K_PROF_R(kMemInit, __VA_ARGS__)
+#define kMemAlloc(...) K_PROF_R(kMemAlloc, __VA_ARGS__)
+#define kMemFree(...) K_PROF_R(kMemFree, __VA_ARGS__)
+#define kShBufAlloc(...) K_PROF_R(kShBufAlloc, __VA_ARGS__)
+#define kShBufRetain(...) K_PROF_R(kShBufRetain, __VA_ARGS__)
+#define kShBufRelease(...) K_PROF_R(kShBufRelease, __VA_ARGS__)
+#define kSemaInit(...) K_PROF_R(kSemaInit, __VA_ARGS__)
+#define kSemaWait(...) K_PROF_R(kSemaWait, __VA_ARGS__)
+#define kSemaSignal(...) K_PROF_V(kSemaSignal, __VA_ARGS__)
+#define kSemaQuery(...) K_PROF_R(kSemaQuery, __VA_ARGS__)
+#define kMutexInit(...) K_PROF_R(kMutexInit, __VA_ARGS__)
+#define kMutexLock(...) K_PROF_R(kMutexLock, __VA_ARGS__)
+#define kMutexUnlock(...) K_PROF_V(kMutexUnlock, __VA_ARGS__)
+#define kMutexQuery(...) K_PROF_R(kMutexQuery, __VA_ARGS__)
+#define kMutexInitCeil(...) K_PROF_R(kMutexInitCeil, __VA_ARGS__)
+#define kNotify(...) K_PROF_R(kNotify, __VA_ARGS__)
+#define kNotifyFromISR(...) K_PROF_R(kNotifyFromISR, __VA_ARGS__)
+#define kNotifyWait(...) K_PROF_R(kNotifyWait, __VA_ARGS__)
+#define kEventInit(...) K_PROF_R(kEventInit, __VA_ARGS__)
+#define kEventSleep(...) K_PROF_R(kEventSleep, __VA_ARGS__)
+#define kEventWake(...) K_PROF_V(kEventWake, __VA_ARGS__)
+#define kEventSignal(...) K_PROF_V(kEventSignal, __VA_ARGS__)
+#define kEventQuery(...) K_PROF_R(kEventQuery, __VA_ARGS__)
+#define kMboxInit(...) K_PROF_R(kMboxInit, __VA_ARGS__)
+#define kMboxPost(...) K_PROF_R(kMboxPost, __VA_ARGS__)
+#define kMboxPend(...) K_PROF_R(kMboxPend, __VA_ARGS__)
+#define kMboxIsFull(...) K_PROF_R(kMboxIsFull, __VA_ARGS__)
+#define kMboxPostPend(...) K_PROF_R(kMboxPostPend, __VA_ARGS__)
+#define kMboxTryPost(...) K_PROF_R(kMboxTryPost, __VA_ARGS__)
+#define kMboxPostFromISR(...) K_PROF_R(kMboxPostFromISR, __VA_ARGS__)
+#define kMboxTryPend(...) K_PROF_R(kMboxTryPend, __VA_ARGS__)
+#define kMboxPeek(...) K_PROF_R(kMboxPeek, __VA_ARGS__)
+#define kMboxMailCount(...) K_PROF_R(kMboxMailCount, __VA_ARGS__)
+#define kMboxSetWatermarks(...) K_PROF_R(kMboxSetWatermarks, __VA_ARGS__)
+#define kMboxGetQStats(...) K_PROF_R(kMboxGetQStats, __VA_ARGS__)
+#define kMboxWatermarkNotify(...) K_PROF_R(kMboxWatermarkNotify, __VA_ARGS__)
+#define kMesgQInit(...) K_PROF_R(kMesgQInit, __VA_ARGS__)
+#define kMesgQGetMesgCount(...) K_PROF_R(kMesgQGetMesgCount, __VA_ARGS__)
+#define kMesgQJam(...) K_PROF_R(kMesgQJam, __VA_ARGS__)
+#define kMesgQRecv(...) K_PROF_R(kMesgQRecv, __VA_ARGS__)
+#define kMesgQSend(...) K_PROF_R(kMesgQSend, __VA_ARGS__)
+#define kMesgQSendV(...) K_PROF_R(kMesgQSendV, __VA_ARGS__)
+#define kMesgQRecvV(...) K_PROF_R(kMesgQRecvV, __VA_ARGS__)
+#define kMesgQPeek(...) K_PROF_R(kMesgQPeek, __VA_ARGS__)
+#define kMesgQSetWatermarks(...) K_PROF_R(kMesgQSetWatermarks, __VA_ARGS__)
+#define kMesgQGetQStats(...) K_PROF_R(kMesgQGetQStats, __VA_ARGS__)
+#define kMesgQWatermarkNotify(...) K_PROF_R(kMesgQWatermarkNotify, __VA_ARGS__)
+#define kMesgQSetOverwrite(...) K_PROF_R(kMesgQSetOverwrite, __VA_ARGS__)
+#define kMesgQGetDropCount(...) K_PROF_R(kMesgQGetDropCount, __VA_ARGS__)
+#define kPMesgQInit(...) K_PROF_R(kPMesgQInit, __VA_ARGS__)
+#define kPMesgQSend(...) K_PROF_R(kPMesgQSend, __VA_ARGS__)
+#define kPMesgQRecv(...) K_PROF_R(kPMesgQRecv, __VA_ARGS__)
+#define kPMesgQGetMesgCount(...) K_PROF_R(kPMesgQGetMesgCount, __VA_ARGS__)
+#define kBcastInit(...) K_PROF_R(kBcastInit, __VA_ARGS__)
+#define kBcastAttach(...) K_PROF_R(kBcastAttach, __VA_ARGS__)
+#define kBcastDetach(...) K_PROF_R(kBcastDetach, __VA_ARGS__)
+#define kBcastPublish(...) K_PROF_R(kBcastPublish, __VA_ARGS__)
+#define kBcastRead(...) K_PROF_R(kBcastRead, __VA_ARGS__)
+#define kBcastAcquire(...) K_PROF_R(kBcastAcquire, __VA_ARGS__)
+#define kBcastRelease(...) K_PROF_R(kBcastRelease, __VA_ARGS__)
+#define kBcastGetLost(...) K_PROF_R(kBcastGetLost, __VA_ARGS__)
+#define kSnapInit(...) K_PROF_R(kSnapInit, __VA_ARGS__)
+#define kSnapWrite(...) K_PROF_R(kSnapWrite, __VA_ARGS__)
+#define kSnapRead(...) K_PROF_R(kSnapRead, __VA_ARGS__)
+#define kSnapVersion(...) K_PROF_R(kSnapVersion, __VA_ARGS__)
+#define kBusTopicInit(...) K_PROF_R(kBusTopicInit, __VA_ARGS__)
+#define kBusSubscribe(...) K_PROF_R(kBusSubscribe, __VA_ARGS__)
+#define kBusSubscribeCallback(...) K_PROF_R(kBusSubscribeCallback, __VA_ARGS__)
+#define kBusUnsubscribe(...) K_PROF_R(kBusUnsubscribe, __VA_ARGS__)
+#define kBusAlloc(...) K_PROF_R(kBusAlloc, __VA_ARGS__)
+#define kBusPublish(...) K_PROF_R(kBusPublish, __VA_ARGS__)
+#define kBusRecv(...) K_PROF_R(kBusRecv, __VA_ARGS__)
+#define kBusRetain(...) K_PROF_V(kBusRetain, __VA_ARGS__)
+#define kBusRelease(...) K_PROF_R(kBusRelease, __VA_ARGS__)
+#define kBusGetStats(...) K_PROF_R(kBusGetStats, __VA_ARGS__)
+#define kRdvInit(...) K_PROF_R(kRdvInit, __VA_ARGS__)
+#define kRdvCall(...) K_PROF_R(kRdvCall, __VA_ARGS__)
+#define kRdvAccept(...) K_PROF_R(kRdvAccept, __VA_ARGS__)
+#define kRdvReply(...) K_PROF_R(kRdvReply, __VA_ARGS__)
+#define kPDQInit(...) K_PROF_R(kPDQInit, __VA_ARGS__)
+#define kPDQReserve(...) K_PROF_R(kPDQReserve, __VA_ARGS__)
+#define kPDQPump(...) K_PROF_R(kPDQPump, __VA_ARGS__)
+#define kPDQFetch(...) K_PROF_R(kPDQFetch, __VA_ARGS__)
+#define kPDQDrop(...) K_PROF_R(kPDQDrop, __VA_ARGS__)
+
+#endif /* K_CODE */
+
+#endif /* K_DEF_PROFILE */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* KPROF_H */
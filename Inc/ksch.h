@@ -24,7 +24,39 @@ extern K_TCBQ readyQueue[K_DEF_MIN_PRIO + 2]; /* Table of ready queues */
 extern K_TCBQ sleepingQueue;
 extern K_TCBQ timeOutQueue;
 
+/* stack paint: words never written keep K_STACK_PAINT */
+#define K_STACK_PAINT    (0xBADC0FFE)
+#define K_STACK_SENTINEL (0x0BADC0DE) /* lowest word of every stack */
+
+#if (K_DEF_STACKMON==ON)
+VOID kStackScanStep(VOID);
+#endif
+
+#if (K_DEF_CPULOAD==ON)
+extern UINT32 volatile kIdleCycles; /* cycles the idle task slept */
+#endif
+
+#if (K_DEF_LATENCY==ON)
+/* a wake request: the latency runs until the task is switched in */
+#define K_WAKE_STAMP(tcbPtr) \
+	(tcbPtr)->wakeStamp = K_CYCLE_CNT; \
+	(tcbPtr)->wakeArmed = TRUE;
+#else
+#define K_WAKE_STAMP(tcbPtr)
+#endif
+
+#if (K_DEF_CONTENTION==ON)
+/* the running task blocks on kobj: the wait is closed when it is switched in */
+#define K_CONTENTION_BLOCK(kobj, statsPtr, holderPtr, holderCyclesPtr) \
+	kContentionBegin((ADDR) (kobj), (statsPtr), (holderPtr), (holderCyclesPtr));
+VOID kContentionBegin(ADDR, K_CONTENTION*, K_TCB*, UINT32*);
+VOID kContentionReset(K_CONTENTION*);
+#else
+#define K_CONTENTION_BLOCK(kobj, statsPtr, holderPtr, holderCyclesPtr)
+#endif
+
 BOOL kSchNeedReschedule(K_TCB*);
+VOID kSchSetPrio(K_TCB*, PRIO);
 VOID kSchSwtch(VOID);
 UINT32 kEnterCR(VOID);
 VOID kExitCR(UINT32);
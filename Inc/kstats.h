@@ -0,0 +1,32 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  In this header:
+ *                  o Private API: kernel statistics block
+ *
+ *****************************************************************************/
+
+#ifndef KSTATS_H
+#define KSTATS_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "kconfig.h"
+#include "ktypes.h"
+#include "kobjs.h"
+
+#if (K_DEF_STATS==ON)
+
+extern K_STATS kStats;
+extern UINT32 kStatsSwitchStamp; /* cycle count of the last switch */
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* KSTATS_H */
@@ -14,12 +14,20 @@ extern K_TIMER *dTimSleepList; /* sleep delay list */
 
 extern K_TIMEOUT_NODE* timeOutListHeadPtr ;
 VOID kTimeOut(K_TIMEOUT_NODE *timeOutNode, TICK timeout);
+VOID kTimeOutCancel(K_TIMEOUT_NODE *timeOutNode);
 VOID kRemoveTaskFromMbox(ADDR kobj);
 void kRemoveTaskFromSema(void *kobj);
 VOID kRemoveTaskFromMutex(ADDR kobj);
 VOID kRemoveTaskFromQueue(ADDR kobj);
+VOID kRemoveTaskFromPMesgQ(ADDR kobj);
 BOOL kHandleTimeoutList(void);
 VOID kRemoveTaskFromEvent(ADDR kobj);
+VOID kRemoveTaskFromNotify(ADDR kobj);
+VOID kRemoveTaskFromBcastReader(ADDR kobj);
+VOID kRemoveTaskFromBcastWriter(ADDR kobj);
+VOID kRemoveTaskFromBusSub(ADDR kobj);
+VOID kRemoveTaskFromRdvCaller(ADDR kobj);
+VOID kRemoveTaskFromRdvServer(ADDR kobj);
 
 extern struct kRunTime runTime; /* record of run time */
 
@@ -0,0 +1,46 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  In this header:
+ *                  o Private API: trace recorder hooks
+ *
+ *****************************************************************************/
+
+#ifndef KTRACE_H
+#define KTRACE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "kconfig.h"
+#include "ktypes.h"
+#include "kobjs.h"
+
+#if (K_DEF_TRACE==ON)
+
+extern K_TRACE_BUF kTrace;
+
+VOID kTraceInit(VOID);
+VOID kTraceRecord(K_TRACE_EVT const, PID const, UINT16 const, ADDR const);
+
+#define K_TRACE(evt, pid, arg, obj) \
+	kTraceRecord((evt), (PID) (pid), (UINT16) (arg), (ADDR) (obj));
+
+/* the running task is about to block on kobj */
+#define K_TRACE_BLOCK(kobj) \
+	K_TRACE(K_TRACE_BLOCK, runPtr->pid, runPtr->status, (kobj))
+
+#else
+
+#define K_TRACE(evt, pid, arg, obj)
+#define K_TRACE_BLOCK(kobj)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* KTRACE_H */
@@ -88,6 +88,19 @@ typedef enum kErr
 	K_ERR_MESGQ_FULL = 0xB,
 	K_ERR_MESGQ_EMPTY = 0xC,
 	K_ERR_MUTEX_LOCKED = 0xD,
+	K_ERR_MUTEX_CEIL_VIOL = 0xE,
+	K_ERR_NOTIFY_EMPTY = 0xF,
+	K_ERR_BCAST_FULL = 0x10,
+	K_ERR_BCAST_EMPTY = 0x11,
+	K_ERR_BCAST_LAGGED = 0x12,
+	K_ERR_SNAP_EMPTY = 0x13,
+	K_ERR_SNAP_SEEN = 0x14,
+	K_ERR_SNAP_BUSY = 0x15,
+	K_ERR_RDV_NO_SERVER = 0x16,
+	K_ERR_RDV_NO_CALLER = 0x17,
+	K_ERR_RDV_BUSY = 0x18,
+	K_ERR_LOG_FULL = 0x19,
+	K_ERR_BUS_EMPTY = 0x1A,
 
 	/* FAULTY RETURN VALUES: negative */
 	K_ERROR = (int) 0xFFFFFFFF, /* (0xFFFFFFFF) Generic error placeholder */
@@ -158,6 +171,8 @@ typedef enum kFault
 	FAULT_UNLOCK_OWNED_MUTEX = 0x5F,
 	FAULT_ISR_INVALID_PRIMITVE = 0x6F,
 	FAULT_TASK_INVALID_STATE = 0x7F,
+	FAULT_CPU_EXCEPTION = 0x8F, /* HardFault, MemManage, BusFault, UsageFault */
+	FAULT_STACK_OVERFLOW = 0x9F, /* Stack sentinel overwritten */
 	FAULT_INVALID_SVC = 0xFF
 } K_FAULT;
 
@@ -172,9 +187,60 @@ typedef enum kTaskStatus
 
 } K_TASK_STATUS;
 
+/**
+ * \brief Task notification actions
+ */
+typedef enum kNotifyAction
+{
+	K_NOTIFY_NONE = 0, /* value is untouched, task is only woken */
+	K_NOTIFY_SET_BITS, /* value |= arg */
+	K_NOTIFY_INCREMENT, /* value += 1 */
+	K_NOTIFY_OVERWRITE /* value = arg */
+} K_NOTIFY_ACTION;
+
+/**
+ * \brief Trace recorder events
+ */
+typedef enum kTraceEvt
+{
+	K_TRACE_NONE = 0,
+	K_TRACE_SWITCH, /* pid: task in, arg: task out | (its status << 8) */
+	K_TRACE_READY, /* pid: task readied, obj: object it waited on */
+	K_TRACE_BLOCK, /* pid: task, arg: status, obj: object */
+	K_TRACE_TIMEOUT, /* arg: object type, obj: object */
+	K_TRACE_TIMER, /* obj: expired timer */
+	K_TRACE_ISR_ENTER, /* arg: exception number */
+	K_TRACE_ISR_EXIT, /* arg: exception number */
+	K_TRACE_USER /* arg and obj set by the application */
+} K_TRACE_EVT;
+
+/**
+ * \brief Broadcast ring policy when the slowest reader is a full ring behind
+ */
+typedef enum kBcastPolicy
+{
+	K_BCAST_WAIT = 0, /* writer blocks */
+	K_BCAST_OVERWRITE /* writer overwrites; lapped readers skip ahead */
+} K_BCAST_POLICY;
+
+/**
+ * \brief Objects whose fill is reported in the statistics block
+ */
+typedef enum kStatsObj
+{
+	K_STATS_NONE = 0,
+	K_STATS_MESGQ, /* used: messages; events: overwritten messages */
+	K_STATS_MBOX, /* used: mails */
+	K_STATS_MEM, /* used: allocated blocks */
+	K_STATS_PDQ /* used: allocated buffers; events: failed reserves */
+} K_STATS_OBJ;
+
 typedef struct kTcb K_TCB;
 typedef struct kTimer K_TIMER;
 typedef struct kMemBlock K_MEM;
+#if (K_DEF_SHBUF == ON)
+typedef struct kShBuf K_SHBUF;
+#endif
 typedef struct kList K_LIST;
 typedef struct kListNode K_LISTNODE;
 typedef K_LIST K_TCBQ;
@@ -188,8 +254,27 @@ typedef struct kSema K_SEMA;
 
 typedef struct kMesgQ K_MESGQ;
 
+/* Scatter-gather fragment */
+typedef struct kMesgFrag
+{
+	void *ptr;
+	SIZE len;
+} K_MESG_FRAG;
+#if (K_DEF_PMESGQ == ON)
+typedef struct kPMesgQ K_PMESGQ;
+typedef struct kPMesgQNode K_PMESGQ_NODE;
+#endif
+
 #endif /*mesgq*/
 
+#if (K_DEF_QWATERMARK == ON)
+
+typedef struct kQWatermark K_QWATERMARK;
+typedef struct kQStats K_QSTATS;
+typedef void (*K_QWM_CALLBACK)(void*, BOOL, void*); /* queue, high, argument */
+
+#endif
+
 #if (K_DEF_MBOX == ON)
 
 typedef struct kMailbox K_MBOX;
@@ -202,6 +287,100 @@ typedef struct kEvent K_EVENT;
 
 #endif
 
+#if (K_DEF_BCAST == ON)
+
+typedef struct kBcast K_BCAST;
+typedef struct kBcastReader K_BCAST_READER;
+
+#endif
+
+#if (K_DEF_SNAP == ON)
+
+typedef struct kSnap K_SNAP;
+
+#endif
+
+#if (K_DEF_BUS == ON)
+
+typedef struct kBusTopic K_BUS_TOPIC;
+typedef struct kBusSub K_BUS_SUB;
+typedef struct kBusMsg K_BUS_MSG;
+typedef struct kBusStats K_BUS_STATS;
+typedef void (*K_BUS_CALLBACK)(K_BUS_MSG*, void*); /* message, argument */
+
+#endif
+
+#if (K_DEF_RDV == ON)
+
+typedef struct kRdv K_RDV;
+
+#endif
+
+#if (K_DEF_STATS == ON)
+
+typedef struct kStatsTask K_STATS_TASK;
+typedef struct kStatsObjEntry K_STATS_OBJ_ENTRY;
+typedef struct kStats K_STATS;
+typedef VOID (*K_STATS_OUTPUT)(BYTE const*, SIZE); /* byte sink */
+
+#endif
+
+#if (K_DEF_CPULOAD == ON)
+
+typedef struct kCpuLoad K_CPULOAD;
+
+#endif
+
+#if (K_DEF_CONTENTION == ON)
+
+typedef struct kContention K_CONTENTION;
+typedef struct kContentionSlot K_CONTENTION_SLOT;
+
+#endif
+
+#if (K_DEF_LATENCY == ON)
+
+typedef struct kLatency K_LATENCY;
+
+#endif
+
+#if (K_DEF_PROFILE == ON)
+
+typedef struct kProfCtx K_PROF_CTX;
+typedef struct kProfStat K_PROF_STAT;
+typedef int (*K_PROF_PRINTF)(const char*, ...); /* e.g. printf */
+
+#endif
+
+#if (K_DEF_LOG == ON)
+
+typedef struct kLogRec K_LOG_REC;
+typedef struct kLogBuf K_LOG_BUF;
+typedef VOID (*K_LOG_OUTPUT)(BYTE const*, SIZE); /* byte sink */
+
+#endif
+
+#if (K_DEF_PCSAMPLE == ON)
+
+typedef struct kPcSampleSlot K_PCSAMPLE_SLOT;
+typedef struct kPcSampleBuf K_PCSAMPLE_BUF;
+
+#endif
+
+#if (K_DEF_TRACE == ON)
+
+typedef struct kTraceRec K_TRACE_REC;
+typedef struct kTraceBuf K_TRACE_BUF;
+
+#endif
+
+#if (K_DEF_CRASHDUMP == ON)
+
+typedef struct kCrashTask K_CRASH_TASK;
+typedef struct kCrashDump K_CRASH_DUMP;
+
+#endif
+
 #if (K_DEF_PDQ== ON)
 
 typedef struct kPumpDropBuf K_PDBUF;
@@ -0,0 +1,389 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  Module           : Inter-task Communication
+ *  Depends on       : Memory Block Allocator, Inter-task Synchronisation
+ *  Provides to      : Application
+ *  Public API       : Yes
+ *
+ *  In this unit:
+ *  				 Publish/Subscribe Bus
+ *
+ *****************************************************************************/
+
+/*******************************************************************************
+ * A topic owns a block pool. A publisher allocates a message from it, fills
+ * the payload in place and publishes it. Every subscriber gets a reference
+ * to the same block, never a copy:
+ *
+ *  - a queued subscriber keeps message pointers on a small ring and its task
+ *    receives them with kBusRecv, releasing each one when done;
+ *  - a callback subscriber is called in the publisher context, with the
+ *    publisher reference held for the duration of the call.
+ *
+ * The block goes back to the pool when the last reference is released.
+ * Queued subscribers blocked on an empty ring all wait on the topic queue,
+ * and one publish readies all of them with a single reschedule.
+ *
+ * A full subscriber ring discards its oldest message (counted as a drop):
+ * a slow subscriber never stalls the publisher or the other subscribers.
+ * A subscriber that goes away must kBusUnsubscribe, which releases the
+ * messages still on its ring.
+ ******************************************************************************/
+
+#define K_CODE
+#include "kconfig.h"
+#include "kobjs.h"
+#include "kitc.h"
+#include "klist.h"
+#include "kmem.h"
+#include "kutils.h"
+#include "kinternals.h"
+#include "ktimer.h"
+#include "katomic.h"
+#include "ktrace.h"
+#include "ksch.h"
+
+#if (K_DEF_BUS==ON)
+
+#define K_BUS_SUB_DEPTH(sub) ((UINT32) ((sub)->tailIdx - (sub)->headIdx))
+
+K_ERR kBusTopicInit(K_BUS_TOPIC *const kobj, STRING const name,
+		K_MEM *const memPtr)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (memPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	if (memPtr->blkSize <= sizeof(K_BUS_MSG))
+	{
+		return (K_ERR_INVALID_MESG_SIZE);
+	}
+	K_ENTER_CR
+	kobj->name = name;
+	kobj->memPtr = memPtr;
+	kobj->subsPtr = NULL;
+	kobj->stats.nPublished = 0;
+	kobj->stats.nAllocFail = 0;
+	kobj->stats.nDropped = 0;
+	kobj->stats.lastPubTick = 0;
+	kobj->stats.minInterval = 0xFFFFFFFF;
+	kobj->stats.maxInterval = 0;
+	kobj->stats.maxLag = 0;
+	K_ERR err = kListInit(&kobj->waitingQueue, "busWaitQ");
+	if (err != 0)
+	{
+		K_EXIT_CR
+		return (K_ERROR);
+	}
+	kobj->init = TRUE;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+static VOID kBusAttach_(K_BUS_TOPIC *const kobj, K_BUS_SUB *const sub)
+{
+	sub->topicPtr = kobj;
+	sub->headIdx = 0;
+	sub->tailIdx = 0;
+	sub->waitingPtr = NULL;
+	sub->nDropped = 0;
+	sub->maxLag = 0;
+	sub->timeoutNode.nextPtr = NULL;
+	sub->timeoutNode.timeout = 0;
+	sub->timeoutNode.kobj = sub;
+	sub->timeoutNode.objectType = BUSSUB;
+	sub->nextPtr = kobj->subsPtr;
+	kobj->subsPtr = sub;
+}
+
+K_ERR kBusSubscribe(K_BUS_TOPIC *const kobj, K_BUS_SUB *const sub,
+		K_BUS_MSG **const ringPtr, SIZE const depth)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (sub == NULL) || (ringPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	if (kobj->init == FALSE)
+	{
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	/* depth must be a power of two */
+	if ((depth == 0) || ((depth & (depth - 1)) != 0))
+	{
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	K_ENTER_CR
+	sub->callback = NULL;
+	sub->cbArgPtr = NULL;
+	sub->ringPtr = ringPtr;
+	sub->mask = (UINT32) (depth - 1);
+	kBusAttach_(kobj, sub);
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kBusSubscribeCallback(K_BUS_TOPIC *const kobj, K_BUS_SUB *const sub,
+		K_BUS_CALLBACK const callback, ADDR const argPtr)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (sub == NULL) || (callback == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	if (kobj->init == FALSE)
+	{
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	K_ENTER_CR
+	sub->callback = callback;
+	sub->cbArgPtr = argPtr;
+	sub->ringPtr = NULL;
+	sub->mask = 0;
+	kBusAttach_(kobj, sub);
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_BUS_MSG* kBusAlloc(K_BUS_TOPIC *const kobj)
+{
+	if ((kobj == NULL) || (kobj->init == FALSE))
+	{
+		return (NULL);
+	}
+	K_BUS_MSG *msgPtr = (K_BUS_MSG*) BLKALLOC(kobj->memPtr);
+	if (msgPtr == NULL)
+	{
+		K_CR_AREA
+		K_ENTER_CR
+		kobj->stats.nAllocFail++;
+		K_EXIT_CR
+		return (NULL);
+	}
+	msgPtr->topicPtr = kobj;
+	msgPtr->refCnt = 1; /* the publisher */
+	msgPtr->stamp = 0;
+	msgPtr->size = kobj->memPtr->blkSize - sizeof(K_BUS_MSG);
+	return (msgPtr);
+}
+
+VOID kBusRetain(K_BUS_MSG *const msgPtr)
+{
+	kAtomicAdd(&msgPtr->refCnt, 1);
+}
+
+K_ERR kBusRelease(K_BUS_MSG *const msgPtr)
+{
+	if (msgPtr == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	/* only the last holder sees it reach zero */
+	if (kAtomicAdd(&msgPtr->refCnt, -1) == 0U)
+	{
+		return (BLKFREE(msgPtr->topicPtr->memPtr, msgPtr));
+	}
+	return (K_SUCCESS);
+}
+
+K_ERR kBusUnsubscribe(K_BUS_SUB *const sub)
+{
+	K_CR_AREA
+	if (sub == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	K_BUS_TOPIC *kobj = sub->topicPtr;
+	if (kobj == NULL)
+	{
+		K_EXIT_CR
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	K_BUS_SUB **linkPtr = &kobj->subsPtr;
+	while ((*linkPtr != NULL) && (*linkPtr != sub))
+	{
+		linkPtr = &(*linkPtr)->nextPtr;
+	}
+	if (*linkPtr == NULL)
+	{
+		K_EXIT_CR
+		return (K_ERR_LIST_ITEM_NOT_FOUND);
+	}
+	/* nextPtr is kept: a publisher may be walking the callbacks */
+	*linkPtr = sub->nextPtr;
+	/* a task blocked on this subscriber returns K_ERR_TIMEOUT */
+	if (sub->waitingPtr != NULL)
+	{
+		kTimeOutCancel(&sub->timeoutNode);
+		kRemoveTaskFromBusSub(sub);
+		if (kSchNeedReschedule(runPtr))
+		{
+			K_PEND_CTXTSWTCH
+		}
+	}
+	while (K_BUS_SUB_DEPTH(sub) > 0)
+	{
+		kBusRelease(sub->ringPtr[sub->headIdx & sub->mask]);
+		sub->headIdx++;
+	}
+	sub->topicPtr = NULL;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kBusPublish(K_BUS_TOPIC *const kobj, K_BUS_MSG *const msgPtr)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (msgPtr == NULL) || (msgPtr->topicPtr != kobj))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+
+	K_ENTER_CR
+	TICK now = kTickGet();
+	msgPtr->stamp = now;
+	if (kobj->stats.nPublished > 0)
+	{
+		TICK interval = now - kobj->stats.lastPubTick;
+		if (interval < kobj->stats.minInterval)
+			kobj->stats.minInterval = interval;
+		if (interval > kobj->stats.maxInterval)
+			kobj->stats.maxInterval = interval;
+	}
+	kobj->stats.lastPubTick = now;
+	kobj->stats.nPublished++;
+
+	/* queued subscribers: one reference each */
+	for (K_BUS_SUB *sub = kobj->subsPtr; sub != NULL; sub = sub->nextPtr)
+	{
+		if (sub->callback != NULL)
+		{
+			continue;
+		}
+		if (K_BUS_SUB_DEPTH(sub) > sub->mask)
+		{
+			/* full: the oldest message makes room */
+			K_BUS_MSG *oldPtr = sub->ringPtr[sub->headIdx & sub->mask];
+			sub->headIdx++;
+			sub->nDropped++;
+			kobj->stats.nDropped++;
+			kBusRelease(oldPtr);
+		}
+		kAtomicAdd(&msgPtr->refCnt, 1);
+		sub->ringPtr[sub->tailIdx & sub->mask] = msgPtr;
+		sub->tailIdx++;
+		UINT32 lag = K_BUS_SUB_DEPTH(sub);
+		if (lag > sub->maxLag)
+			sub->maxLag = lag;
+		if (lag > kobj->stats.maxLag)
+			kobj->stats.maxLag = lag;
+		if (sub->waitingPtr != NULL)
+		{
+			kTimeOutCancel(&sub->timeoutNode);
+			sub->waitingPtr = NULL;
+		}
+	}
+	/* every blocked subscriber is readied at once */
+	if (kobj->waitingQueue.size > 0)
+	{
+		kReadyAllCtxtSwtch(&kobj->waitingQueue);
+	}
+	K_EXIT_CR
+
+	/* callback subscribers run with the publisher reference held */
+	for (K_BUS_SUB *sub = kobj->subsPtr; sub != NULL; sub = sub->nextPtr)
+	{
+		if (sub->callback != NULL)
+		{
+			sub->callback(msgPtr, sub->cbArgPtr);
+		}
+	}
+
+	return (kBusRelease(msgPtr));
+}
+
+K_ERR kBusRecv(K_BUS_SUB *const sub, K_BUS_MSG **const msgPPtr,
+		TICK const timeout)
+{
+	K_CR_AREA
+	if ((sub == NULL) || (msgPPtr == NULL) || (sub->ringPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+
+	K_ENTER_CR
+	K_BUS_TOPIC *kobj = sub->topicPtr;
+	if (kobj == NULL)
+	{
+		/* not subscribed */
+		K_EXIT_CR
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	while (K_BUS_SUB_DEPTH(sub) == 0)
+	{
+		if (timeout == 0)
+		{
+			K_EXIT_CR
+			return (K_ERR_BUS_EMPTY);
+		}
+		if (kIsISR())
+		{
+			KFAULT(FAULT_ISR_INVALID_PRIMITVE);
+		}
+		if ((timeout > 0) && (timeout < 0xFFFFFFFF))
+			kTimeOut(&sub->timeoutNode, timeout);
+		sub->waitingPtr = runPtr;
+		kTCBQEnq(&kobj->waitingQueue, runPtr);
+		runPtr->status = RECEIVING;
+		K_TRACE_BLOCK(kobj)
+		K_PEND_CTXTSWTCH
+		K_EXIT_CR
+		K_ENTER_CR
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_EXIT_CR
+			return (K_ERR_TIMEOUT);
+		}
+	}
+	/* the reference moves from the ring to the caller */
+	*msgPPtr = sub->ringPtr[sub->headIdx & sub->mask];
+	sub->headIdx++;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kBusGetStats(K_BUS_TOPIC *const kobj, K_BUS_STATS *const statsPtr,
+		BOOL const clear)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (statsPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	*statsPtr = kobj->stats;
+	if (clear)
+	{
+		kobj->stats.nAllocFail = 0;
+		kobj->stats.nDropped = 0;
+		kobj->stats.minInterval = 0xFFFFFFFF;
+		kobj->stats.maxInterval = 0;
+		kobj->stats.maxLag = 0;
+		for (K_BUS_SUB *sub = kobj->subsPtr; sub != NULL; sub = sub->nextPtr)
+		{
+			sub->nDropped = 0;
+			sub->maxLag = K_BUS_SUB_DEPTH(sub);
+		}
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+#endif /* K_DEF_BUS */
@@ -0,0 +1,192 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  Module           : Crash Dump
+ *  Depends on       : Error Handler, Scheduler
+ *  Provides to      : Application
+ *  Public API       : Yes
+ *
+ *  In this unit:
+ *  				 Fault state capture to no-init RAM
+ *
+ *****************************************************************************/
+
+/*******************************************************************************
+ * kErrHandler, and kFaultEntry for CPU exceptions, save the fault state in
+ * kCrashDump before halting or resetting. kCrashDump lives in .noinit, so
+ * the start-up code leaves it alone and it is read back on the next boot:
+ *
+ *    .noinit (NOLOAD) : { *(.noinit*) } > RAM     (linker script)
+ *
+ * A record is valid when its magic, size and checksum match; power-on
+ * garbage is rejected. The CPU exception handlers only need to branch to
+ * kFaultEntry:
+ *
+ *    __attribute__((naked)) void HardFault_Handler(void)
+ *    { asm volatile ("b kFaultEntry"); }
+ *
+ * The record can be sent by the application on the next boot, or dumped
+ * from the debugger:
+ *
+ *   dump binary memory crash.bin &kCrashDump (&kCrashDump + 1)
+ *
+ * and tools/kcrash.py prints it.
+ ******************************************************************************/
+
+#define K_CODE
+#include "kconfig.h"
+#include "kobjs.h"
+#include "kinternals.h"
+#include "ksch.h"
+#include "kerr.h"
+#include "ktrace.h"
+
+#if (K_DEF_CRASHDUMP==ON)
+
+#define K_CRASH_MAGIC (0x4B435253) /* "KCRS" */
+
+K_CRASH_DUMP kCrashDump __attribute__((section(".noinit")));
+
+static UINT32 kCrashSum_(VOID)
+{
+	UINT32 const *wordPtr = (UINT32 const*) &kCrashDump;
+	UINT32 sum = 0;
+	for (SIZE i = 0; i < sizeof(K_CRASH_DUMP) / sizeof(UINT32); i++)
+	{
+		/* the checksum word is taken as 0 */
+		UINT32 word = (&wordPtr[i] == &kCrashDump.checksum) ? 0U : wordPtr[i];
+		sum = ((sum << 1) | (sum >> 31)) ^ word;
+	}
+	return (sum);
+}
+
+static BOOL kCrashValid_(VOID)
+{
+	return ((kCrashDump.magic == K_CRASH_MAGIC)
+			&& (kCrashDump.size == sizeof(K_CRASH_DUMP))
+			&& (kCrashDump.checksum == kCrashSum_()));
+}
+
+/* interrupts are disabled; nothing here may fault or block */
+VOID kCrashCapture(K_FAULT const fault, UINT32 const *const framePtr,
+		UINT32 const lr)
+{
+	UINT32 nCrashes = (kCrashValid_()) ? (kCrashDump.nCrashes + 1U) : 1U;
+	faultID = fault;
+	UINT32 *wordPtr = (UINT32*) &kCrashDump;
+	for (SIZE i = 0; i < sizeof(K_CRASH_DUMP) / sizeof(UINT32); i++)
+	{
+		wordPtr[i] = 0;
+	}
+	kCrashDump.magic = K_CRASH_MAGIC;
+	kCrashDump.size = sizeof(K_CRASH_DUMP);
+	kCrashDump.pending = TRUE;
+	kCrashDump.nCrashes = nCrashes;
+	kCrashDump.fault = (UINT32) fault;
+	kCrashDump.tick = runTime.globalTick;
+	if (framePtr != NULL)
+	{
+		kCrashDump.hasFrame = TRUE;
+		for (SIZE i = 0; i < 8; i++)
+		{
+			kCrashDump.regs[i] = framePtr[i];
+		}
+	}
+	kCrashDump.lr = lr;
+	kCrashDump.msp = __get_MSP();
+	kCrashDump.psp = __get_PSP();
+	kCrashDump.ipsr = __get_IPSR();
+	kCrashDump.cfsr = SCB->CFSR;
+	kCrashDump.hfsr = SCB->HFSR;
+	kCrashDump.mmfar = SCB->MMFAR;
+	kCrashDump.bfar = SCB->BFAR;
+
+	/* scheduler */
+	kCrashDump.runPtr = (UINT32) runPtr;
+	for (PRIO prio = 0; prio < (K_DEF_MIN_PRIO + 2); prio++)
+	{
+		if (readyQueue[prio].size > 0)
+		{
+			kCrashDump.readyMask |= (1U << prio);
+		}
+	}
+	kCrashDump.nTasks = NTHREADS;
+	for (SIZE i = 0; i < NTHREADS; i++)
+	{
+		kCrashDump.tasks[i].sp = (UINT32) tcbs[i].sp;
+		kCrashDump.tasks[i].stackAddr = (UINT32) tcbs[i].stackAddrPtr;
+		kCrashDump.tasks[i].stackSize = tcbs[i].stackSize;
+		kCrashDump.tasks[i].pid = tcbs[i].pid;
+		kCrashDump.tasks[i].tid = tcbs[i].uPid;
+		kCrashDump.tasks[i].status = (BYTE) tcbs[i].status;
+		kCrashDump.tasks[i].priority = tcbs[i].priority;
+	}
+	if (runPtr != NULL)
+	{
+		kCrashDump.runTcb = *runPtr;
+	}
+
+#if (K_DEF_TRACE==ON)
+	UINT32 head = kTrace.head;
+	UINT32 n = (head < K_DEF_CRASHDUMP_NTRACE) ? head : K_DEF_CRASHDUMP_NTRACE;
+	if (n > K_DEF_TRACE_DEPTH)
+	{
+		n = K_DEF_TRACE_DEPTH;
+	}
+	for (UINT32 i = 0; i < n; i++)
+	{
+		kCrashDump.trace[i] = kTrace.rec[(head - n + i)
+				& (K_DEF_TRACE_DEPTH - 1U)];
+	}
+	kCrashDump.nTrace = n;
+#endif
+
+	kCrashDump.checksum = kCrashSum_();
+	__DSB();
+#if (K_DEF_CRASHDUMP_RESET==ON)
+	NVIC_SystemReset();
+#endif
+}
+
+/* CPU exception: the frame was stacked on the stack EXC_RETURN points to */
+__attribute__((naked)) VOID kFaultEntry(VOID)
+{
+	asm volatile (
+			"cpsid i              \n"
+			"tst   lr, #4         \n"
+			"ite   eq             \n"
+			"mrseq r1, msp        \n"
+			"mrsne r1, psp        \n"
+			"mov   r2, lr         \n"
+			"movs  r0, %0         \n"
+			"bl    kCrashCapture  \n"
+			"b     .              \n"
+			:: "i" (FAULT_CPU_EXCEPTION));
+}
+
+K_CRASH_DUMP const* kCrashDumpGet(VOID)
+{
+	if ((!kCrashValid_()) || (!kCrashDump.pending))
+	{
+		return (NULL);
+	}
+	return (&kCrashDump);
+}
+
+VOID kCrashDumpClear(VOID)
+{
+	K_CR_AREA
+	K_ENTER_CR
+	if (kCrashValid_())
+	{
+		/* nCrashes keeps counting */
+		kCrashDump.pending = FALSE;
+		kCrashDump.checksum = kCrashSum_();
+	}
+	K_EXIT_CR
+}
+
+#endif /* K_DEF_CRASHDUMP */
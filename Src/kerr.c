@@ -61,6 +61,9 @@ void kErrHandler(K_FAULT fault) /* generic error handler */
     /*#ifdef NDEBUG, guarantee these faults are returning correctly  */
     faultID = fault;
     asm volatile ("cpsid i" : : : "memory");
+#if (K_DEF_CRASHDUMP==ON)
+    kCrashCapture(fault, NULL, (UINT32) __builtin_return_address(0));
+#endif
     while (1)
         ;
 }
@@ -0,0 +1,261 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  Module           : Deferred Logging
+ *  Depends on       : Scheduler, Timers
+ *  Provides to      : Application
+ *  Public API       : Yes
+ *
+ *  In this unit:
+ *  				 Lock-free log ring
+ *  				 Log task
+ *
+ *****************************************************************************/
+
+/*******************************************************************************
+ * kLog does not format anything. It claims a record with an exclusive
+ * load/store on the head, stores a cycle stamp, the caller, the format
+ * string address and up to four word arguments, and marks the record
+ * complete. It never masks interrupts, never blocks and can be called
+ * from tasks and ISRs. A full ring drops the record and counts an overrun.
+ *
+ * kLogTask, created by the application at a low priority, drains the ring
+ * every K_DEF_LOG_PERIOD ticks: the formatting and the byte output (the
+ * busy-wait _write by default) only take CPU time nobody else needs.
+ * The reader stops at a record whose writer was preempted before
+ * completing it, and resumes from there on the next drain.
+ *
+ * Arguments are words: integers, characters and pointers (%s must point to
+ * a string that outlives the record, e.g. a literal). No floating point.
+ *
+ * With K_DEF_LOG_BINARY each record goes out as a frame:
+ *
+ *   'K' 'L' stamp:4 fmt:4 pid:1 nArgs:1 args:4*nArgs   (little endian)
+ *
+ * and tools/klog.py formats it on the host, reading the format strings
+ * from the firmware ELF. A frame with a NULL format carries {lost records,
+ * cycle counter frequency}; one is sent on the first drain and after every
+ * overrun.
+ ******************************************************************************/
+
+#define K_CODE
+#include <stdio.h>
+#include "kconfig.h"
+#include "kobjs.h"
+#include "kinternals.h"
+#include "ksch.h"
+#include "ktimer.h"
+#include "kutils.h"
+#include "katomic.h"
+#include "klog.h"
+
+#if (K_DEF_LOG==ON)
+
+#if ((K_DEF_LOG_DEPTH & (K_DEF_LOG_DEPTH - 1)) != 0)
+#error "K_DEF_LOG_DEPTH must be a power of two"
+#endif
+
+#define K_LOG_MASK (K_DEF_LOG_DEPTH - 1U)
+#define K_LOG_LINE (128)
+
+K_LOG_BUF kLogBuf;
+static BOOL logStarted_;
+
+static VOID kLogUart_(BYTE const *const bufPtr, SIZE const size)
+{
+	_write(1, (char*) bufPtr, (int) size);
+}
+
+VOID kLogInit(VOID)
+{
+	kLogBuf.head = 0;
+	kLogBuf.tail = 0;
+	kLogBuf.done = 0;
+	kLogBuf.overruns = 0;
+	kLogBuf.reported = 0;
+	kLogBuf.outputFn = kLogUart_;
+	logStarted_ = FALSE;
+}
+
+K_ERR kLogWrite(STRING const fmt, BYTE const nArgs, UINT32 const arg0,
+		UINT32 const arg1, UINT32 const arg2, UINT32 const arg3)
+{
+	UINT32 stamp = K_CYCLE_CNT;
+	UINT32 head;
+	do
+	{
+		head = kLdrEx(&kLogBuf.head);
+		if ((head - kLogBuf.tail) >= K_DEF_LOG_DEPTH)
+		{
+			kClrEx();
+			kAtomicAdd(&kLogBuf.overruns, 1);
+			return (K_ERR_LOG_FULL);
+		}
+	} while (!kStrEx(&kLogBuf.head, head, head + 1U));
+
+	K_LOG_REC *recPtr = &kLogBuf.rec[head & K_LOG_MASK];
+	recPtr->stamp = stamp;
+	recPtr->fmt = fmt;
+	recPtr->args[0] = arg0;
+	recPtr->args[1] = arg1;
+	recPtr->args[2] = arg2;
+	recPtr->args[3] = arg3;
+	recPtr->nArgs = (nArgs > K_LOG_NARGS) ? K_LOG_NARGS : nArgs;
+	recPtr->pid = ((kIsISR()) || (runPtr == NULL)) ? K_LOG_PID_ISR :
+			runPtr->pid;
+	DMB
+	recPtr->seq = head + 1U;
+	return (K_SUCCESS);
+}
+
+#if (K_DEF_LOG_BINARY==ON)
+
+static SIZE kLogPutWord_(BYTE *const bufPtr, UINT32 const word)
+{
+	bufPtr[0] = (BYTE) word;
+	bufPtr[1] = (BYTE) (word >> 8);
+	bufPtr[2] = (BYTE) (word >> 16);
+	bufPtr[3] = (BYTE) (word >> 24);
+	return (4);
+}
+
+static VOID kLogOutput_(K_LOG_REC const *const recPtr)
+{
+	BYTE buf[12 + 4 * K_LOG_NARGS];
+	SIZE len = 0;
+	buf[len++] = 'K';
+	buf[len++] = 'L';
+	len += kLogPutWord_(&buf[len], recPtr->stamp);
+	len += kLogPutWord_(&buf[len], (UINT32) recPtr->fmt);
+	buf[len++] = recPtr->pid;
+	buf[len++] = recPtr->nArgs;
+	for (SIZE i = 0; i < recPtr->nArgs; i++)
+	{
+		len += kLogPutWord_(&buf[len], recPtr->args[i]);
+	}
+	kLogBuf.outputFn(buf, len);
+}
+
+static VOID kLogLost_(UINT32 const lost)
+{
+	K_LOG_REC rec =
+	{ .stamp = K_CYCLE_CNT, .fmt = NULL, .pid = K_LOG_PID_ISR, .nArgs = 2 };
+	rec.args[0] = lost;
+	rec.args[1] = SystemCoreClock;
+	kLogOutput_(&rec);
+}
+
+#else
+
+static VOID kLogOutput_(K_LOG_REC const *const recPtr)
+{
+	CHAR buf[K_LOG_LINE];
+	UINT32 cyclesPerUs = SystemCoreClock / 1000000U;
+	int len;
+	if (recPtr->pid == K_LOG_PID_ISR)
+	{
+		len = snprintf(buf, sizeof(buf), "[%10lu us] ISR: ",
+				(unsigned long) (recPtr->stamp / (cyclesPerUs ? cyclesPerUs : 1U)));
+	}
+	else
+	{
+		len = snprintf(buf, sizeof(buf), "[%10lu us] %3u: ",
+				(unsigned long) (recPtr->stamp / (cyclesPerUs ? cyclesPerUs : 1U)),
+				(unsigned) recPtr->pid);
+	}
+	/* unused arguments are ignored by the formatter */
+	len += snprintf(&buf[len], sizeof(buf) - (SIZE) len, recPtr->fmt,
+			recPtr->args[0], recPtr->args[1], recPtr->args[2],
+			recPtr->args[3]);
+	if (len >= (int) sizeof(buf))
+	{
+		len = sizeof(buf) - 1;
+	}
+	kLogBuf.outputFn((BYTE const*) buf, (SIZE) len);
+}
+
+static VOID kLogLost_(UINT32 const lost)
+{
+	if (lost > 0U)
+	{
+		CHAR buf[40];
+		int len = snprintf(buf, sizeof(buf), "(log: %lu records lost)\n",
+				(unsigned long) lost);
+		kLogBuf.outputFn((BYTE const*) buf, (SIZE) len);
+	}
+}
+
+#endif /* K_DEF_LOG_BINARY */
+
+UINT32 kLogFlush(VOID)
+{
+	UINT32 n = 0;
+	K_LOG_REC rec;
+	if (!logStarted_)
+	{
+		logStarted_ = TRUE;
+		kLogLost_(0);
+	}
+	while (kLogBuf.tail != kLogBuf.head)
+	{
+		UINT32 tail = kLogBuf.tail;
+		K_LOG_REC *recPtr = &kLogBuf.rec[tail & K_LOG_MASK];
+		if (recPtr->seq != (tail + 1U))
+		{
+			/* its writer has not completed it yet */
+			break;
+		}
+		DMB
+		rec = *recPtr;
+		/* the slot is free for writers from here */
+		kLogBuf.tail = tail + 1U;
+		kLogOutput_(&rec);
+		/* a "%s" argument is no longer read from here */
+		kLogBuf.done = tail + 1U;
+		n++;
+	}
+	UINT32 lost = kLogBuf.overruns - kLogBuf.reported;
+	if (lost > 0U)
+	{
+		kLogBuf.reported += lost;
+		kLogLost_(lost);
+	}
+	return (n);
+}
+
+VOID kLogTask(VOID)
+{
+	for (;;)
+	{
+		kLogFlush();
+		kSleep(K_DEF_LOG_PERIOD);
+	}
+}
+
+VOID kLogSetOutput(K_LOG_OUTPUT const outputFn)
+{
+	kLogBuf.outputFn = (outputFn != NULL) ? outputFn : kLogUart_;
+}
+
+K_ERR kLogGetOverruns(UINT32 *const overrunsPtr, BOOL const clear)
+{
+	if (overrunsPtr == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_CR_AREA
+	K_ENTER_CR
+	*overrunsPtr = kLogBuf.overruns;
+	if (clear)
+	{
+		kLogBuf.overruns = 0;
+		kLogBuf.reported = 0;
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+#endif /* K_DEF_LOG */
@@ -10,6 +10,7 @@
  *  Public API       : Yes
  * 	In this unit	 :
  * 					    o Memory Block Allocator
+ * 					    o Shared (reference-counted) Buffers
  *
  *****************************************************************************/
 
@@ -21,6 +22,7 @@
 #include "kerr.h"
 #include "kinternals.h"
 #include "kmem.h"
+#include "katomic.h"
 
 K_ERR kMemInit(K_MEM* const kobj, ADDR const memPoolPtr,
           BYTE blkSize, BYTE const numBlocks)
@@ -110,3 +112,77 @@ K_ERR kMemFree(K_MEM* const kobj, ADDR const blockPtr)
     return (K_SUCCESS);
 }
 
+#if (K_DEF_SHBUF==ON)
+/*******************************************************************************
+ * SHARED BUFFERS
+ *******************************************************************************
+ * A shared buffer is a block of a K_MEM pool with a small header: the pool it
+ * came from and a reference count. The handle is the block address, so it
+ * fits wherever a pointer does (a mailbox slot, a queue message of
+ * sizeof(K_SHBUF*) bytes). Every holder releases its reference once; the
+ * last release returns the block to its pool. The count is updated with
+ * exclusive load/store, so retain/release do not mask interrupts and are
+ * ISR-safe.
+ ******************************************************************************/
+
+K_SHBUF* kShBufAlloc(K_MEM* const kobj)
+{
+    if (IS_NULL_PTR(kobj) || (kobj->blkSize <= sizeof(K_SHBUF)))
+    {
+        return (NULL);
+    }
+    K_SHBUF* bufPtr = (K_SHBUF*) kMemAlloc(kobj);
+    if (bufPtr != NULL)
+    {
+        bufPtr->memPtr = kobj;
+        bufPtr->refCnt = 1U;
+        bufPtr->size = kobj->blkSize - sizeof(K_SHBUF);
+    }
+    return (bufPtr);
+}
+
+K_ERR kShBufRetain(K_SHBUF* const bufPtr)
+{
+    if (IS_NULL_PTR(bufPtr))
+    {
+        return (K_ERR_OBJ_NULL);
+    }
+    UINT32 cnt;
+    do
+    {
+        cnt = kLdrEx(&bufPtr->refCnt);
+        if (cnt == 0U)
+        {
+            /* already back in the pool */
+            kClrEx();
+            return (K_ERROR);
+        }
+    } while (!kStrEx(&bufPtr->refCnt, cnt, cnt + 1U));
+    return (K_SUCCESS);
+}
+
+K_ERR kShBufRelease(K_SHBUF* const bufPtr)
+{
+    if (IS_NULL_PTR(bufPtr))
+    {
+        return (K_ERR_OBJ_NULL);
+    }
+    UINT32 cnt;
+    do
+    {
+        cnt = kLdrEx(&bufPtr->refCnt);
+        if (cnt == 0U)
+        {
+            kClrEx();
+            return (K_ERROR);
+        }
+    } while (!kStrEx(&bufPtr->refCnt, cnt, cnt - 1U));
+    /* only the last holder sees it reach zero */
+    if (cnt == 1U)
+    {
+        return (kMemFree(bufPtr->memPtr, bufPtr));
+    }
+    return (K_SUCCESS);
+}
+
+#endif /* K_DEF_SHBUF */
@@ -23,6 +23,192 @@
 #include "kutils.h"
 #include "kinternals.h"
 #include "ktimer.h"
+#include "katomic.h"
+#include "ktrace.h"
+
+/*******************************************************************************
+ * WAITING QUEUES
+ *******************************************************************************
+ * Mailboxes and message queues keep senders and receivers on separate
+ * waiting queues. A receiver only waits on an empty object and a sender
+ * only waits on a full one, so at most one of the queues is not empty.
+ *
+ * While blocked, a task keeps the address of its message (sender) or of
+ * its receiving buffer (receiver) in mesgBufPtr. Whoever changes the state
+ * of the object serves the task at the head of the opposite queue directly:
+ * the message is copied from/to that task buffer, mesgBufPtr is set to NULL
+ * to tell it the transfer is done, and the task is readied.
+ ******************************************************************************/
+
+#if ((K_DEF_MBOX==ON) || (K_DEF_MESGQ==ON) || (K_DEF_RDV==ON))
+
+/* readies a task served from a mailbox/queue waiting list */
+static inline VOID kMesgWake_(K_TCB *const tcbPtr)
+{
+	tcbPtr->mesgBufPtr = NULL;
+	kTCBQEnq(&readyQueue[tcbPtr->priority], tcbPtr);
+	tcbPtr->status = READY;
+	K_TRACE(K_TRACE_READY, tcbPtr->pid, 0, NULL)
+	K_WAKE_STAMP(tcbPtr)
+	if (tcbPtr->priority < runPtr->priority)
+	{
+		K_PEND_CTXTSWTCH
+	}
+}
+
+#endif
+
+/*******************************************************************************
+ * WATERMARKS
+ *******************************************************************************
+ * Each multi-item mailbox and message queue can have a high and a low
+ * watermark. The fill level is checked on every change; crossing the high
+ * mark (depth >= high) and later falling back to the low mark (depth <= low)
+ * each fire once: a callback and/or task notification bits. Callbacks run
+ * inside the queue critical section and must not block.
+ ******************************************************************************/
+
+#if ((K_DEF_QWATERMARK==ON) && ((K_DEF_MESGQ==ON) || \
+		((K_DEF_MBOX==ON) && (K_DEF_MBOX_CAPACITY==MULTI))))
+
+static VOID kQWatermarkInit_(K_QWATERMARK *const wmPtr)
+{
+	wmPtr->high = 0;
+	wmPtr->low = 0;
+	wmPtr->above = FALSE;
+	wmPtr->callback = NULL;
+	wmPtr->cbArgPtr = NULL;
+#if (K_DEF_TASK_NOTIFY==ON)
+	wmPtr->notifyTask = FALSE;
+	wmPtr->notifyTID = 0;
+	wmPtr->highBits = 0;
+	wmPtr->lowBits = 0;
+#endif
+	wmPtr->stats.peakDepth = 0;
+	wmPtr->stats.timeAboveHigh = 0;
+	wmPtr->stats.blockedSends = 0;
+	wmPtr->stats.highCrossings = 0;
+	wmPtr->aboveSince = 0;
+}
+
+static VOID kQWatermarkFire_(K_QWATERMARK *const wmPtr, ADDR const kobj,
+		BOOL const high)
+{
+	if (wmPtr->callback != NULL)
+	{
+		wmPtr->callback(kobj, high, wmPtr->cbArgPtr);
+	}
+#if (K_DEF_TASK_NOTIFY==ON)
+	if (wmPtr->notifyTask)
+	{
+		/* readies the task without switching from inside the queue */
+		kNotifyFromISR(wmPtr->notifyTID,
+				(high) ? wmPtr->highBits : wmPtr->lowBits, K_NOTIFY_SET_BITS);
+	}
+#endif
+}
+
+/* called with the new depth after every change of the fill level */
+static VOID kQWatermarkUpdate_(K_QWATERMARK *const wmPtr, ADDR const kobj,
+		SIZE const depth)
+{
+	if (depth > wmPtr->stats.peakDepth)
+	{
+		wmPtr->stats.peakDepth = depth;
+	}
+	if (wmPtr->high == 0)
+	{
+		return; /* no watermarks set */
+	}
+	if ((!wmPtr->above) && (depth >= wmPtr->high))
+	{
+		wmPtr->above = TRUE;
+		wmPtr->aboveSince = kTickGet();
+		wmPtr->stats.highCrossings++;
+		kQWatermarkFire_(wmPtr, kobj, TRUE);
+	}
+	else if ((wmPtr->above) && (depth <= wmPtr->low))
+	{
+		wmPtr->above = FALSE;
+		wmPtr->stats.timeAboveHigh += kTickGet() - wmPtr->aboveSince;
+		kQWatermarkFire_(wmPtr, kobj, FALSE);
+	}
+}
+
+static K_ERR kQWatermarkSet_(K_QWATERMARK *const wmPtr, SIZE const high,
+		SIZE const low, SIZE const capacity, K_QWM_CALLBACK const callback,
+		ADDR const argPtr)
+{
+	K_CR_AREA
+	if ((high == 0) || (high > capacity) || (low >= high))
+	{
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	K_ENTER_CR
+	wmPtr->high = high;
+	wmPtr->low = low;
+	wmPtr->above = FALSE;
+	wmPtr->callback = callback;
+	wmPtr->cbArgPtr = argPtr;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+#if (K_DEF_TASK_NOTIFY==ON)
+static K_ERR kQWatermarkNotify_(K_QWATERMARK *const wmPtr, TID const taskID,
+		UINT32 const highBits, UINT32 const lowBits)
+{
+	K_CR_AREA
+	if (kGetTaskPID(taskID) >= NTHREADS)
+	{
+		return (K_ERR_INVALID_TID);
+	}
+	K_ENTER_CR
+	wmPtr->notifyTID = taskID;
+	wmPtr->highBits = highBits;
+	wmPtr->lowBits = lowBits;
+	wmPtr->notifyTask = TRUE;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+#endif
+
+static VOID kQWatermarkStats_(K_QWATERMARK *const wmPtr,
+		K_QSTATS *const statsPtr, SIZE const depth, BOOL const clear)
+{
+	K_CR_AREA
+	K_ENTER_CR
+	*statsPtr = wmPtr->stats;
+	if (wmPtr->above)
+	{
+		/* the ongoing period counts too */
+		TICK now = kTickGet();
+		statsPtr->timeAboveHigh += now - wmPtr->aboveSince;
+		if (clear)
+		{
+			wmPtr->aboveSince = now;
+		}
+	}
+	if (clear)
+	{
+		wmPtr->stats.peakDepth = depth;
+		wmPtr->stats.timeAboveHigh = 0;
+		wmPtr->stats.blockedSends = 0;
+		wmPtr->stats.highCrossings = 0;
+	}
+	K_EXIT_CR
+}
+
+#define K_QWM_UPDATE(kobj, depth) \
+	kQWatermarkUpdate_(&(kobj)->watermark, (kobj), (depth))
+#define K_QWM_BLOCKED_SEND(kobj)  ((kobj)->watermark.stats.blockedSends++)
+
+#else
+
+#define K_QWM_UPDATE(kobj, depth)
+#define K_QWM_BLOCKED_SEND(kobj)
+
+#endif /* K_DEF_QWATERMARK */
 
 /*******************************************************************************
  * MAILBOX
@@ -30,6 +216,21 @@
 
 #if (K_DEF_MBOX==ON)
 
+#if(K_DEF_MBOX_ENQ==K_DEF_ENQ_FIFO)
+#define K_MBOX_WAIT_ENQ(q, t) kTCBQEnq(q, t)
+#else
+#define K_MBOX_WAIT_ENQ(q, t) kTCBQEnqByPrio(q, t)
+#endif
+
+/* no one waits anymore: the object time-out is disarmed */
+#define K_MBOX_TIMEOUT_DISARM(kobj) \
+	do \
+	{ \
+		if (((kobj)->sendersQueue.size == 0) \
+				&& ((kobj)->receiversQueue.size == 0)) \
+			kTimeOutCancel(&(kobj)->timeoutNode); \
+	} while(0U)
+
 #if (K_DEF_MBOX_CAPACITY==SINGLE)
 
 K_ERR kMboxInit(K_MBOX *const kobj, ADDR initMailPtr)
@@ -44,12 +245,16 @@ K_ERR kMboxInit(K_MBOX *const kobj, ADDR initMailPtr)
 	K_ENTER_CR
 	kobj->mailPtr = initMailPtr;
 	K_ERR listerr;
-	listerr = kListInit(&kobj->waitingQueue, "mailq");
+	listerr = kListInit(&kobj->sendersQueue, "mailSendQ");
+	listerr |= kListInit(&kobj->receiversQueue, "mailRecvQ");
 	assert(listerr == 0);
 	kobj->timeoutNode.nextPtr = NULL;
 	kobj->timeoutNode.timeout = 0;
 	kobj->timeoutNode.kobj = kobj;
 	kobj->timeoutNode.objectType = MAILBOX;
+#if (K_DEF_CONTENTION==ON)
+	kContentionReset(&kobj->contention);
+#endif
 	kobj->init = TRUE;
 	K_EXIT_CR
 	return (K_SUCCESS);
@@ -72,6 +277,19 @@ K_ERR kMboxPost(K_MBOX *const kobj, ADDR const sendPtr, TICK timeout)
 	{
 		KFAULT(FAULT_OBJ_NOT_INIT);
 	}
+	/* a receiver is waiting: the mail goes straight to it */
+	if (kobj->receiversQueue.size > 0)
+	{
+		K_TCB *freeReadPtr;
+		kTCBQDeq(&kobj->receiversQueue, &freeReadPtr);
+		assert(freeReadPtr != NULL);
+		*((ADDR*) freeReadPtr->mesgBufPtr) = sendPtr;
+		freeReadPtr->pendingMbox = NULL;
+		kMesgWake_(freeReadPtr);
+		K_MBOX_TIMEOUT_DISARM(kobj);
+		K_EXIT_CR
+		return (K_SUCCESS);
+	}
 	/* a reader is yet to read */
 	if (kobj->mailPtr != NULL)
 	{
@@ -84,44 +302,35 @@ K_ERR kMboxPost(K_MBOX *const kobj, ADDR const sendPtr, TICK timeout)
 		{
 			kTimeOut(&kobj->timeoutNode, timeout);
 		}
+		runPtr->mesgBufPtr = sendPtr;
 		do
 		{
 			/* not-empty blocks a writer */
-#if(K_DEF_MBOX_ENQ==K_DEF_ENQ_FIFO)
-			kTCBQEnq(&kobj->waitingQueue, runPtr);
-#else
-			kTCBQEnqByPrio(&kobj->waitingQueue, runPtr);
-#endif
+			K_MBOX_WAIT_ENQ(&kobj->sendersQueue, runPtr);
 			runPtr->status = SENDING;
+			K_TRACE_BLOCK(kobj)
+			K_CONTENTION_BLOCK(kobj, &kobj->contention, NULL, NULL)
 			K_PEND_CTXTSWTCH
 			K_EXIT_CR
 			K_ENTER_CR
+			if (runPtr->mesgBufPtr == NULL)
+			{
+				/* a reader took our mail in */
+				K_EXIT_CR
+				return (K_SUCCESS);
+			}
 			if (runPtr->timeOut)
 			{
 				runPtr->timeOut = FALSE;
+				runPtr->mesgBufPtr = NULL;
 				K_EXIT_CR
 				return (K_ERR_TIMEOUT);
 			}
 		} while (kobj->mailPtr != NULL);
+		runPtr->mesgBufPtr = NULL;
 	}
 
 	kobj->mailPtr = sendPtr;
-
-	/*  full: unblock a reader, if any */
-	if (kobj->waitingQueue.size > 0)
-	{
-		K_TCB *freeReadPtr;
-		freeReadPtr = kTCBQPeek(&kobj->waitingQueue);
-		if (freeReadPtr->status == RECEIVING)
-		{
-			kTCBQDeq(&kobj->waitingQueue, &freeReadPtr);
-			assert(freeReadPtr != NULL);
-			kTCBQEnq(&readyQueue[freeReadPtr->priority], freeReadPtr);
-			freeReadPtr->status = READY;
-			if (freeReadPtr->priority < runPtr->priority)
-				K_PEND_CTXTSWTCH
-		}
-	}
 	K_EXIT_CR
 	return (K_SUCCESS);
 }
@@ -133,6 +342,7 @@ K_ERR kMboxPend(K_MBOX *const kobj, ADDR *recvPPtr, TICK timeout)
 
 	if (kIsISR())
 	{
+		K_EXIT_CR
 		return (K_ERR_MBOX_ISR);
 	}
 	if ((kobj == NULL) || (recvPPtr == NULL))
@@ -154,45 +364,46 @@ K_ERR kMboxPend(K_MBOX *const kobj, ADDR *recvPPtr, TICK timeout)
 		{
 			kTimeOut(&kobj->timeoutNode, timeout);
 		}
-
+		runPtr->mesgBufPtr = recvPPtr;
 		do
 		{
-
-#if(K_DEF_MBOX_ENQ==K_DEF_ENQ_FIFO)
-			kTCBQEnq(&kobj->waitingQueue, runPtr);
-#else
-			kTCBQEnqByPrio(&kobj->waitingQueue, runPtr);
-#endif
+			K_MBOX_WAIT_ENQ(&kobj->receiversQueue, runPtr);
 			runPtr->status = RECEIVING;
+			K_TRACE_BLOCK(kobj)
+			K_CONTENTION_BLOCK(kobj, &kobj->contention, NULL, NULL)
 			runPtr->pendingMbox = kobj;
 			K_PEND_CTXTSWTCH
 			K_EXIT_CR
 			K_ENTER_CR
+			if (runPtr->mesgBufPtr == NULL)
+			{
+				/* a writer handed the mail over */
+				K_EXIT_CR
+				return (K_SUCCESS);
+			}
 			if (runPtr->timeOut)
 			{ /* timed-out */
 				runPtr->timeOut = FALSE;
-				runPtr->pendingMbox = 0;
+				runPtr->pendingMbox = NULL;
+				runPtr->mesgBufPtr = NULL;
 				K_EXIT_CR
 				return (K_ERR_TIMEOUT);
 			}
 		} while (kobj->mailPtr == NULL);
+		runPtr->pendingMbox = NULL;
+		runPtr->mesgBufPtr = NULL;
 	}
 
 	*recvPPtr = kobj->mailPtr;
 	kobj->mailPtr = NULL;
-	/* it only makes sense do deq a writer */
-	if (kobj->waitingQueue.size > 0)
+	/* empty: take the mail of the first blocked writer, if any */
+	if (kobj->sendersQueue.size > 0)
 	{
 		K_TCB *freeWriterPtr;
-		freeWriterPtr = kTCBQPeek(&kobj->waitingQueue);
-		if (freeWriterPtr->status == SENDING)
-		{
-			kTCBQDeq(&kobj->waitingQueue, &freeWriterPtr);
-			kTCBQEnq(&readyQueue[freeWriterPtr->priority], freeWriterPtr);
-			freeWriterPtr->status = READY;
-			if ((freeWriterPtr->priority < runPtr->priority))
-				K_PEND_CTXTSWTCH
-		}
+		kTCBQDeq(&kobj->sendersQueue, &freeWriterPtr);
+		kobj->mailPtr = freeWriterPtr->mesgBufPtr;
+		kMesgWake_(freeWriterPtr);
+		K_MBOX_TIMEOUT_DISARM(kobj);
 	}
 
 	K_EXIT_CR
@@ -222,7 +433,7 @@ K_ERR kMboxPostPend(K_MBOX *const kobj, ADDR const sendPtr,
 	{
 		KFAULT(FAULT_ISR_INVALID_PRIMITVE);
 	}
-	if ((kobj == NULL) || (sendPtr == NULL))
+	if ((kobj == NULL) || (sendPtr == NULL) || (recvPPtr == NULL))
 	{
 		KFAULT(FAULT_NULL_OBJ);
 	}
@@ -230,86 +441,121 @@ K_ERR kMboxPostPend(K_MBOX *const kobj, ADDR const sendPtr,
 	{
 		KFAULT(FAULT_OBJ_NOT_INIT);
 	}
+	/* the request goes straight to a waiting receiver, if any */
+	K_ERR err = kMboxPost(kobj, sendPtr, timeout);
+	if (err != K_SUCCESS)
+	{
+		return (err);
+	}
 	K_ENTER_CR
-	/* a reader is yet to read */
-	if (kobj->mailPtr != NULL)
+	if (kobj->mailPtr != sendPtr)
 	{
-		if (timeout == 0)
-		{
-			K_EXIT_CR
-			return (K_ERR_MBOX_FULL);
-		}
-		if ((timeout > 0) && (timeout < 0xFFFFFFFF))
-		{
-			kTimeOut(&kobj->timeoutNode, timeout);
-		}
-
-		do
-		{
-			/* not-empty blocks a writer */
-#if(K_DEF_MBOX_ENQ==K_DEF_ENQ_FIFO)
-			kTCBQEnq(&kobj->waitingQueue, runPtr);
-#else
-			kTCBQEnqByPrio(&kobj->waitingQueue, runPtr);
-#endif
-			runPtr->status = RECEIVING;
-			K_PEND_CTXTSWTCH
-			K_EXIT_CR
-			K_ENTER_CR
-			if (runPtr->timeOut)
-			{
-				runPtr->timeOut = FALSE;
-				K_EXIT_CR
-				return (K_ERR_TIMEOUT);
-			}
-		} while (kobj->mailPtr != NULL);
+		/* a server has the request: wait as a receiver for the answer */
+		K_EXIT_CR
+		return (kMboxPend(kobj, recvPPtr, timeout));
 	}
-
-	kobj->mailPtr = sendPtr;
-
-	/*  full: unblock a reader, if any */
-	if (kobj->waitingQueue.size > 0)
+	/* the request is still in the box and a pend would read it back.
+	 * wait on the receivers queue instead: the server pend takes the
+	 * request and its post hands the answer over to us. */
+	if (timeout == 0)
 	{
-		K_TCB *freeReadPtr;
-		freeReadPtr = kTCBQPeek(&kobj->waitingQueue);
-		if (freeReadPtr->status == RECEIVING)
-		{
-			kTCBQDeq(&kobj->waitingQueue, &freeReadPtr);
-			assert(freeReadPtr != NULL);
-			kTCBQEnq(&readyQueue[freeReadPtr->priority], freeReadPtr);
-			freeReadPtr->status = READY;
-		}
-		/* do not pend here */
+		err = K_ERR_MBOX_EMPTY;
 	}
-	/* will pend after waiting for a recv */
-	do
+	else
 	{
-#if(K_DEF_MBOX_ENQ==K_DEF_ENQ_FIFO)
-		kTCBQEnq(&kobj->waitingQueue, runPtr);
-#else
-		kTCBQEnqByPrio(&kobj->waitingQueue, runPtr);
-#endif
+		if (timeout < 0xFFFFFFFF)
+		{
+			kTimeOut(&kobj->timeoutNode, timeout);
+		}
+		runPtr->mesgBufPtr = recvPPtr;
+		K_MBOX_WAIT_ENQ(&kobj->receiversQueue, runPtr);
 		runPtr->status = RECEIVING;
+		K_TRACE_BLOCK(kobj)
+		K_CONTENTION_BLOCK(kobj, &kobj->contention, NULL, NULL)
+		runPtr->pendingMbox = kobj;
 		K_PEND_CTXTSWTCH
 		K_EXIT_CR
 		K_ENTER_CR
-		if (runPtr->timeOut)
+		runPtr->pendingMbox = NULL;
+		if (runPtr->mesgBufPtr == NULL)
 		{
-			runPtr->timeOut = FALSE;
+			/* the answer was handed over */
 			K_EXIT_CR
-			return (K_ERR_TIMEOUT);
+			return (K_SUCCESS);
 		}
-		/* while mailPtr does not change or is only read */
-	} while (kobj->mailPtr == sendPtr);
-	*recvPPtr = kobj->mailPtr;
-	kobj->mailPtr = NULL; /* empty again */
+		runPtr->timeOut = FALSE;
+		runPtr->mesgBufPtr = NULL;
+		err = K_ERR_TIMEOUT;
+	}
+	/* no answer: withdraw the request if no server took it */
+	if (kobj->mailPtr == sendPtr)
+	{
+		kobj->mailPtr = NULL;
+		if (kobj->sendersQueue.size > 0)
+		{
+			K_TCB *freeWriterPtr;
+			kTCBQDeq(&kobj->sendersQueue, &freeWriterPtr);
+			kobj->mailPtr = freeWriterPtr->mesgBufPtr;
+			kMesgWake_(freeWriterPtr);
+		}
+	}
 	K_EXIT_CR
-	return (K_SUCCESS);
+	return (err);
 }
 #endif /* sendrecv */
 
 #elif (K_DEF_MBOX_CAPACITY==(MULTI))
 
+/* head and tail are free-running; the ring capacity is a power of two */
+#define K_MBOX_COUNT(kobj)  ((SIZE) ((kobj)->tailIdx - (kobj)->headIdx))
+#define K_MBOX_FULL(kobj)   (K_MBOX_COUNT(kobj) > (kobj)->mask)
+
+/* deliver a mail: straight to a waiting receiver, else on the ring tail.
+ * FALSE if full. */
+static inline BOOL kMboxPut_(K_MBOX *const kobj, ADDR const sendPtr)
+{
+	if (kobj->receiversQueue.size > 0)
+	{
+		K_TCB *freeReadPtr;
+		kTCBQDeq(&kobj->receiversQueue, &freeReadPtr);
+		*((ADDR*) freeReadPtr->mesgBufPtr) = sendPtr;
+		kMesgWake_(freeReadPtr);
+		K_MBOX_TIMEOUT_DISARM(kobj);
+		return (TRUE);
+	}
+	if (K_MBOX_FULL(kobj))
+	{
+		return (FALSE);
+	}
+	kobj->mailQPtr[kobj->tailIdx & kobj->mask] = sendPtr;
+	kobj->tailIdx++;
+	K_QWM_UPDATE(kobj, K_MBOX_COUNT(kobj));
+	return (TRUE);
+}
+
+/* take the ring head and refill the freed slot from a blocked sender.
+ * FALSE if empty. */
+static inline BOOL kMboxGet_(K_MBOX *const kobj, ADDR *const recvPPtr)
+{
+	if (K_MBOX_COUNT(kobj) == 0)
+	{
+		return (FALSE);
+	}
+	*recvPPtr = kobj->mailQPtr[kobj->headIdx & kobj->mask];
+	kobj->headIdx++;
+	if (kobj->sendersQueue.size > 0)
+	{
+		K_TCB *freeSendPtr;
+		kTCBQDeq(&kobj->sendersQueue, &freeSendPtr);
+		kobj->mailQPtr[kobj->tailIdx & kobj->mask] = freeSendPtr->mesgBufPtr;
+		kobj->tailIdx++;
+		kMesgWake_(freeSendPtr);
+		K_MBOX_TIMEOUT_DISARM(kobj);
+	}
+	K_QWM_UPDATE(kobj, K_MBOX_COUNT(kobj));
+	return (TRUE);
+}
+
 K_ERR kMboxInit(K_MBOX *const kobj, ADDR memPtr, SIZE maxItems)
 {
 	K_CR_AREA
@@ -319,17 +565,28 @@ K_ERR kMboxInit(K_MBOX *const kobj, ADDR memPtr, SIZE maxItems)
 		KFAULT(FAULT_NULL_OBJ);
 		return (K_ERROR);
 	}
+	/* capacity must be a power of two */
+	if ((maxItems & (maxItems - 1)) != 0)
+	{
+		return (K_ERR_MBOX_SIZE);
+	}
 
 	K_ENTER_CR
 
-	kobj->mailQPtr = memPtr;
+	kobj->mailQPtr = (ADDR*) memPtr;
 	kobj->headIdx = 0;
 	kobj->tailIdx = 0;
-	kobj->maxItems = maxItems;
-	kobj->countItems = 0;
+	kobj->mask = maxItems - 1;
+#if (K_DEF_QWATERMARK==ON)
+	kQWatermarkInit_(&kobj->watermark);
+#endif
+#if (K_DEF_CONTENTION==ON)
+	kContentionReset(&kobj->contention);
+#endif
 	kobj->init = TRUE;
 
-	K_ERR listerr = kListInit(&kobj->waitingQueue, "qq");
+	K_ERR listerr = kListInit(&kobj->sendersQueue, "mailSendQ");
+	listerr |= kListInit(&kobj->receiversQueue, "mailRecvQ");
 	assert(listerr == 0);
 
 	kobj->timeoutNode.nextPtr = NULL;
@@ -357,59 +614,92 @@ K_ERR kMboxPost(K_MBOX *const kobj, ADDR sendPtr, TICK timeout)
 	}
 	K_ENTER_CR
 
-	if (kobj->countItems == kobj->maxItems)
+	if (kMboxPut_(kobj, sendPtr))
 	{
-		if (timeout == 0)
+		K_EXIT_CR
+		return (K_SUCCESS);
+	}
+	if (timeout == 0)
+	{
+		K_EXIT_CR
+		return (K_ERR_MBOX_FULL);
+	}
+	if (kIsISR())
+	{
+		KFAULT(FAULT_ISR_INVALID_PRIMITVE);
+	}
+	if ((timeout > 0) && (timeout < 0xFFFFFFFF))
+	{
+		kTimeOut(&kobj->timeoutNode, timeout);
+	}
+	runPtr->mesgBufPtr = sendPtr;
+	K_QWM_BLOCKED_SEND(kobj);
+	do
+	{
+		K_MBOX_WAIT_ENQ(&kobj->sendersQueue, runPtr);
+		runPtr->status = SENDING;
+		K_TRACE_BLOCK(kobj)
+		K_CONTENTION_BLOCK(kobj, &kobj->contention, NULL, NULL)
+		K_PEND_CTXTSWTCH
+		K_EXIT_CR
+		K_ENTER_CR
+		if (runPtr->mesgBufPtr == NULL)
 		{
+			/* a reader took our mail in */
 			K_EXIT_CR
-			return (K_ERR_MBOX_FULL);
+			return (K_SUCCESS);
 		}
-
-		do
+		if (runPtr->timeOut)
 		{
-			kTCBQEnq(&kobj->waitingQueue, runPtr);
-			runPtr->status = SENDING;
-			kTimeOut(&kobj->timeoutNode, timeout);
-			K_PEND_CTXTSWTCH
+			runPtr->timeOut = FALSE;
+			runPtr->mesgBufPtr = NULL;
 			K_EXIT_CR
-			K_ENTER_CR
+			return (K_ERR_TIMEOUT);
+		}
+	} while (K_MBOX_FULL(kobj));
+	runPtr->mesgBufPtr = NULL;
 
-			if (runPtr->timeOut)
-			{
-				runPtr->timeOut = FALSE;
-				K_EXIT_CR
-				return (K_ERR_TIMEOUT);
-			}
-		} while (kobj->countItems == kobj->maxItems);
-	}
+	BOOL posted = kMboxPut_(kobj, sendPtr);
+	assert(posted);
+	(VOID) posted;
 
-	/* post on tail */
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
 
-	ADDR *tailAddr = (ADDR*) ((UINT*) kobj->mailQPtr + kobj->tailIdx);
-	*tailAddr = sendPtr;
+K_ERR kMboxTryPost(K_MBOX *const kobj, ADDR const sendPtr)
+{
+	K_CR_AREA
 
-	kobj->tailIdx = (kobj->tailIdx + 1) % kobj->maxItems;
+	if (kIsISR())
+	{
+		KFAULT(FAULT_ISR_INVALID_PRIMITVE);
+	}
+	if (kobj == NULL || sendPtr == NULL)
+	{
+		KFAULT(FAULT_NULL_OBJ);
+		return (K_ERROR);
+	}
+	K_ENTER_CR
+	BOOL posted = kMboxPut_(kobj, sendPtr);
+	K_EXIT_CR
+	return ((posted) ? (K_SUCCESS) : (K_ERR_MBOX_FULL));
+}
 
-	kobj->countItems++;
+K_ERR kMboxPostFromISR(K_MBOX *const kobj, ADDR const sendPtr)
+{
+	K_CR_AREA
 
-	/* unblock a receiver if any */
-	if (kobj->waitingQueue.size > 0)
+	if (kobj == NULL || sendPtr == NULL)
 	{
-		K_TCB *freeReadPtr = kTCBQPeek(&kobj->waitingQueue);
-		if (freeReadPtr->status == RECEIVING)
-		{
-			kTCBQDeq(&kobj->waitingQueue, &freeReadPtr);
-			kTCBQEnq(&readyQueue[freeReadPtr->priority], freeReadPtr);
-			freeReadPtr->status = READY;
-			if (freeReadPtr->priority < runPtr->priority)
-			{
-				K_PEND_CTXTSWTCH
-			}
-		}
+		KFAULT(FAULT_NULL_OBJ);
+		return (K_ERROR);
 	}
-
+	/* a receiver readied here is switched in on the exception return */
+	K_ENTER_CR
+	BOOL posted = kMboxPut_(kobj, sendPtr);
 	K_EXIT_CR
-	return (K_SUCCESS);
+	return ((posted) ? (K_SUCCESS) : (K_ERR_MBOX_FULL));
 }
 
 K_ERR kMboxPend(K_MBOX *const kobj, ADDR *recvPPtr, TICK timeout)
@@ -428,58 +718,72 @@ K_ERR kMboxPend(K_MBOX *const kobj, ADDR *recvPPtr, TICK timeout)
 		return (K_ERROR);
 	}
 
-	if (kobj->countItems == 0)
+	if (kMboxGet_(kobj, recvPPtr))
 	{
-		if (timeout == 0)
+		K_EXIT_CR
+		return (K_SUCCESS);
+	}
+	if (timeout == 0)
+	{
+		K_EXIT_CR
+		return (K_ERR_MBOX_EMPTY);
+	}
+	if (kIsISR())
+	{
+		K_EXIT_CR
+		return (K_ERR_MBOX_ISR);
+	}
+	if ((timeout > 0) && (timeout < 0xFFFFFFFF))
+	{
+		kTimeOut(&kobj->timeoutNode, timeout);
+	}
+	runPtr->mesgBufPtr = recvPPtr;
+	do
+	{
+		K_MBOX_WAIT_ENQ(&kobj->receiversQueue, runPtr);
+		runPtr->status = RECEIVING;
+		K_TRACE_BLOCK(kobj)
+		K_CONTENTION_BLOCK(kobj, &kobj->contention, NULL, NULL)
+		K_PEND_CTXTSWTCH
+		K_EXIT_CR
+		K_ENTER_CR
+		if (runPtr->mesgBufPtr == NULL)
 		{
+			/* a writer handed the mail over */
 			K_EXIT_CR
-			return (K_ERR_MBOX_EMPTY);
+			return (K_SUCCESS);
 		}
-
-		do
+		if (runPtr->timeOut)
 		{
-			kTCBQEnqByPrio(&kobj->waitingQueue, runPtr);
-			runPtr->status = RECEIVING;
-			kTimeOut(&kobj->timeoutNode, timeout);
-			K_PEND_CTXTSWTCH
+			runPtr->timeOut = FALSE;
+			runPtr->mesgBufPtr = NULL;
 			K_EXIT_CR
-			K_ENTER_CR
-
-			if (runPtr->timeOut)
-			{
-				runPtr->timeOut = FALSE;
-				K_EXIT_CR
-				return (K_ERR_TIMEOUT);
-			}
-		} while (kobj->countItems == 0);
-	}
+			return (K_ERR_TIMEOUT);
+		}
+	} while (K_MBOX_COUNT(kobj) == 0);
+	runPtr->mesgBufPtr = NULL;
 
-	// Calculate the address of the head and retrieve the mail
-	ADDR *headAddr = (ADDR*) ((UINT*) kobj->mailQPtr + kobj->headIdx);
-	*recvPPtr = *headAddr;
+	BOOL got = kMboxGet_(kobj, recvPPtr);
+	assert(got);
+	(VOID) got;
 
-	// Advance the head offset
-	kobj->headIdx = (kobj->headIdx + 1) % kobj->maxItems;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
 
-	kobj->countItems--;
+K_ERR kMboxTryPend(K_MBOX *const kobj, ADDR *const recvPPtr)
+{
+	K_CR_AREA
 
-	if (kobj->waitingQueue.size > 0)
+	if (kobj == NULL || recvPPtr == NULL)
 	{
-		K_TCB *freeSendPtr = kTCBQPeek(&kobj->waitingQueue);
-		if (freeSendPtr->status == SENDING)
-		{
-			kTCBQDeq(&kobj->waitingQueue, &freeSendPtr);
-			kTCBQEnqByPrio(&readyQueue[freeSendPtr->priority], freeSendPtr);
-			freeSendPtr->status = READY;
-			if (freeSendPtr->priority < runPtr->priority)
-			{
-				K_PEND_CTXTSWTCH
-			}
-		}
+		KFAULT(FAULT_NULL_OBJ);
+		return (K_ERROR);
 	}
-
+	K_ENTER_CR
+	BOOL got = kMboxGet_(kobj, recvPPtr);
 	K_EXIT_CR
-	return (K_SUCCESS);
+	return ((got) ? (K_SUCCESS) : (K_ERR_MBOX_EMPTY));
 }
 
 K_ERR kMboxPeek(K_MBOX *const kobj, ADDR *peekPPtr)
@@ -501,9 +805,13 @@ K_ERR kMboxPeek(K_MBOX *const kobj, ADDR *peekPPtr)
 		return (K_ERROR);
 	}
 
-	ADDR *headAddr = (ADDR*) ((UINT*) kobj->mailQPtr + kobj->headIdx);
+	if (K_MBOX_COUNT(kobj) == 0)
+	{
+		K_EXIT_CR
+		return (K_ERR_MBOX_EMPTY);
+	}
 
-	*peekPPtr = *headAddr;
+	*peekPPtr = kobj->mailQPtr[kobj->headIdx & kobj->mask];
 
 	K_EXIT_CR
 
@@ -512,15 +820,71 @@ K_ERR kMboxPeek(K_MBOX *const kobj, ADDR *peekPPtr)
 
 SIZE kMboxMailCount(K_MBOX *const kobj)
 {
-	return (kobj->countItems);
+	return (K_MBOX_COUNT(kobj));
 }
 
 BOOL kMboxIsFull(K_MBOX *const kobj)
 {
-	return (kobj->countItems == kobj->maxItems);
+	return (K_MBOX_FULL(kobj));
+}
+
+#if (K_DEF_QWATERMARK==ON)
+K_ERR kMboxSetWatermarks(K_MBOX *const kobj, SIZE const high, SIZE const low,
+		K_QWM_CALLBACK const callback, ADDR const argPtr)
+{
+	if (kobj == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	return (kQWatermarkSet_(&kobj->watermark, high, low, kobj->mask + 1,
+			callback, argPtr));
+}
+
+#if (K_DEF_TASK_NOTIFY==ON)
+K_ERR kMboxWatermarkNotify(K_MBOX *const kobj, TID const taskID,
+		UINT32 const highBits, UINT32 const lowBits)
+{
+	if (kobj == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	return (kQWatermarkNotify_(&kobj->watermark, taskID, highBits, lowBits));
+}
+#endif
+
+K_ERR kMboxGetQStats(K_MBOX *const kobj, K_QSTATS *const statsPtr,
+		BOOL const clear)
+{
+	if ((kobj == NULL) || (statsPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	kQWatermarkStats_(&kobj->watermark, statsPtr, K_MBOX_COUNT(kobj), clear);
+	return (K_SUCCESS);
 }
+#endif
 
 #endif /* mailbox type */
+
+#if (K_DEF_CONTENTION==ON)
+K_ERR kMboxGetContention(K_MBOX *const kobj, K_CONTENTION *const statsPtr,
+		BOOL const clear)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (statsPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	*statsPtr = kobj->contention;
+	if (clear)
+	{
+		kContentionReset(&kobj->contention);
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+#endif
 #endif /* mailbox */
 
 /*******************************************************************************
@@ -528,6 +892,213 @@ BOOL kMboxIsFull(K_MBOX *const kobj)
  *******************************************************************************/
 #if(K_DEF_MESGQ==ON)
 
+#if(K_DEF_MESGQ_ENQ==K_DEF_ENQ_FIFO)
+#define K_MESGQ_WAIT_ENQ(q, t) kTCBQEnq(q, t)
+#else
+#define K_MESGQ_WAIT_ENQ(q, t) kTCBQEnqByPrio(q, t)
+#endif
+
+/* no one waits anymore: the object time-out is disarmed */
+#define K_MESGQ_TIMEOUT_DISARM(kobj) \
+	do \
+	{ \
+		if (((kobj)->sendersQueue.size == 0) \
+				&& ((kobj)->receiversQueue.size == 0)) \
+			kTimeOutCancel(&(kobj)->timeoutNode); \
+	} while(0U)
+
+/* copies size bytes between two buffers, each either contiguous (nFrags 0)
+ * or an array of nFrags K_MESG_FRAG. returns the number of bytes copied. */
+static SIZE kMesgCopy_(ADDR const dstPtr, SIZE const nDst, ADDR const srcPtr,
+		SIZE const nSrc, SIZE const size)
+{
+	SIZE n = 0;
+	if ((nDst == 0) && (nSrc == 0))
+	{
+		CPYQ(dstPtr, srcPtr, size, n);
+		return (n);
+	}
+	K_MESG_FRAG dstOne = { dstPtr, size };
+	K_MESG_FRAG srcOne = { srcPtr, size };
+	K_MESG_FRAG const *dst = (nDst == 0) ? &dstOne : (K_MESG_FRAG const*) dstPtr;
+	K_MESG_FRAG const *src = (nSrc == 0) ? &srcOne : (K_MESG_FRAG const*) srcPtr;
+	SIZE const nD = (nDst == 0) ? 1 : nDst;
+	SIZE const nS = (nSrc == 0) ? 1 : nSrc;
+	SIZE di = 0, dOff = 0, si = 0, sOff = 0;
+	while ((n < size) && (di < nD) && (si < nS))
+	{
+		if (dOff == dst[di].len)
+		{
+			di++;
+			dOff = 0;
+			continue;
+		}
+		if (sOff == src[si].len)
+		{
+			si++;
+			sOff = 0;
+			continue;
+		}
+		((BYTE*) dst[di].ptr)[dOff++] = ((BYTE const*) src[si].ptr)[sOff++];
+		n++;
+	}
+	return (n);
+}
+
+/* copies a message into the ring, on the tail or, when jamming, on the head */
+static inline K_ERR kMesgQPut_(K_MESGQ *const kobj, ADDR const src,
+		SIZE const nFrags, BOOL const jam)
+{
+	SIZE err = 0;
+	if (jam)
+	{
+		SIZE idx =
+				(kobj->readIndex == 0) ?
+						(kobj->maxMesg - 1) : (kobj->readIndex - 1);
+		BYTE *dest = kobj->buffer + (idx * kobj->mesgSize);
+		err = kMesgCopy_(dest, 0, src, nFrags, kobj->mesgSize);
+		if (err != kobj->mesgSize)
+		{
+			return (K_ERR_MESG_CPY);
+		}
+		kobj->readIndex = idx;
+	}
+	else
+	{
+		BYTE *dest = kobj->buffer + (kobj->writeIndex * kobj->mesgSize);
+		err = kMesgCopy_(dest, 0, src, nFrags, kobj->mesgSize);
+		if (err != kobj->mesgSize)
+		{
+			return (K_ERR_MESG_CPY);
+		}
+		kobj->writeIndex = (kobj->writeIndex + 1) % kobj->maxMesg;
+	}
+	kobj->mesgCnt++;
+	K_QWM_UPDATE(kobj, kobj->mesgCnt);
+	return (K_SUCCESS);
+}
+
+/* a slot was freed: the first blocked sender has its message taken in */
+static inline VOID kMesgQServeSender_(K_MESGQ *const kobj)
+{
+	if (kobj->sendersQueue.size > 0)
+	{
+		K_TCB *freeSendPtr;
+		kTCBQDeq(&kobj->sendersQueue, &freeSendPtr);
+		K_ERR err = kMesgQPut_(kobj, freeSendPtr->mesgBufPtr,
+				freeSendPtr->mesgNFrags, freeSendPtr->mesgJam);
+		assert(err == K_SUCCESS);
+		(VOID) err;
+		kMesgWake_(freeSendPtr);
+		K_MESGQ_TIMEOUT_DISARM(kobj);
+	}
+}
+
+/* common send path for tail (send) and head (jam) insertion.
+ * sendPtr is the message, or a K_MESG_FRAG array when nFrags > 0 */
+static K_ERR kMesgQPost_(K_MESGQ *const kobj, ADDR const sendPtr,
+		SIZE const nFrags, TICK const timeout, BOOL const jam)
+{
+	K_CR_AREA
+
+	if ((kobj == NULL) || (sendPtr == NULL) || (kobj->init == 0))
+	{
+		return (K_ERROR);
+	}
+	if (kIsISR())
+		KFAULT(FAULT_ISR_INVALID_PRIMITVE);
+
+	K_ENTER_CR
+
+	/* a receiver waits on an empty queue: hand the message over */
+	if (kobj->receiversQueue.size > 0)
+	{
+		K_TCB *freeRecvPtr;
+		kTCBQDeq(&kobj->receiversQueue, &freeRecvPtr);
+		SIZE err = kMesgCopy_(freeRecvPtr->mesgBufPtr,
+				freeRecvPtr->mesgNFrags, sendPtr, nFrags, kobj->mesgSize);
+		if (err != kobj->mesgSize)
+		{
+			/* the receiver keeps waiting */
+			kTCBQEnq(&kobj->receiversQueue, freeRecvPtr);
+			K_EXIT_CR
+			return (K_ERR_MESG_CPY);
+		}
+		kMesgWake_(freeRecvPtr);
+		K_MESGQ_TIMEOUT_DISARM(kobj);
+		K_EXIT_CR
+		return (K_SUCCESS);
+	}
+
+#if (K_DEF_MESGQ_OVERWRITE==ON)
+	if ((kobj->overwrite) && (kobj->mesgCnt >= kobj->maxMesg))
+	{
+		/* drop the oldest to make room */
+		kobj->readIndex = (kobj->readIndex + 1) % kobj->maxMesg;
+		kobj->mesgCnt--;
+		kobj->dropCnt++;
+	}
+#endif
+	if (kobj->mesgCnt >= kobj->maxMesg) /*full*/
+	{
+		if (timeout == 0)
+		{
+			K_EXIT_CR
+			return (K_ERR_MESGQ_FULL);
+		}
+
+		if ((timeout > 0) && (timeout < 0xFFFFFFFF))
+			kTimeOut(&kobj->timeoutNode, timeout);
+		runPtr->mesgBufPtr = sendPtr;
+		runPtr->mesgNFrags = nFrags;
+		runPtr->mesgJam = jam;
+		K_QWM_BLOCKED_SEND(kobj);
+		do
+		{
+			K_MESGQ_WAIT_ENQ(&kobj->sendersQueue, runPtr);
+			runPtr->status = SENDING;
+			K_TRACE_BLOCK(kobj)
+			K_CONTENTION_BLOCK(kobj, &kobj->contention, NULL, NULL)
+
+			K_PEND_CTXTSWTCH
+			K_EXIT_CR
+			K_ENTER_CR
+			if (runPtr->mesgBufPtr == NULL)
+			{
+				/* a receiver took our message in */
+				K_EXIT_CR
+				return (K_SUCCESS);
+			}
+			if (runPtr->timeOut)
+			{
+				runPtr->timeOut = FALSE;
+				runPtr->mesgBufPtr = NULL;
+				K_EXIT_CR
+				return (K_ERR_TIMEOUT);
+			}
+		} while (kobj->mesgCnt >= kobj->maxMesg);
+		runPtr->mesgBufPtr = NULL;
+	}
+	K_ERR err = kMesgQPut_(kobj, sendPtr, nFrags, jam);
+	K_EXIT_CR
+	return (err);
+}
+
+/* total length of a fragment list */
+static SIZE kMesgFragLen_(K_MESG_FRAG const *const frags, SIZE const nFrags)
+{
+	SIZE len = 0;
+	for (SIZE i = 0; i < nFrags; i++)
+	{
+		if ((frags[i].ptr == NULL) && (frags[i].len != 0))
+		{
+			return (0);
+		}
+		len += frags[i].len;
+	}
+	return (len);
+}
+
 K_ERR kMesgQInit(K_MESGQ *const kobj, ADDR const buffer, SIZE const mesgSize,
 		SIZE const nMesg)
 {
@@ -551,7 +1122,8 @@ K_ERR kMesgQInit(K_MESGQ *const kobj, ADDR const buffer, SIZE const mesgSize,
 	kobj->mesgCnt = 0;
 	kobj->readIndex = 0;
 	kobj->writeIndex = 0;
-	K_ERR err = kListInit(&kobj->waitingQueue, "waitingQueue");
+	K_ERR err = kListInit(&kobj->sendersQueue, "sendersQueue");
+	err |= kListInit(&kobj->receiversQueue, "receiversQueue");
 	if (err != 0)
 	{
 		K_EXIT_CR
@@ -561,6 +1133,16 @@ K_ERR kMesgQInit(K_MESGQ *const kobj, ADDR const buffer, SIZE const mesgSize,
 	kobj->timeoutNode.timeout = 0;
 	kobj->timeoutNode.kobj = kobj;
 	kobj->timeoutNode.objectType = MESGQUEUE;
+#if (K_DEF_MESGQ_OVERWRITE==ON)
+	kobj->overwrite = FALSE;
+	kobj->dropCnt = 0;
+#endif
+#if (K_DEF_QWATERMARK==ON)
+	kQWatermarkInit_(&kobj->watermark);
+#endif
+#if (K_DEF_CONTENTION==ON)
+	kContentionReset(&kobj->contention);
+#endif
 	kobj->init = 1;
 	K_EXIT_CR
 	return (K_SUCCESS);
@@ -585,7 +1167,6 @@ K_ERR kMesgQPeek(K_MESGQ *const kobj, ADDR recvPtr)
 	CPYQ(dest, src, kobj->mesgSize, err);
 	if (err != kobj->mesgSize)
 	{
-		kobj->readIndex = (kobj->readIndex + 1) % kobj->maxMesg;
 		K_EXIT_CR
 		return (K_ERR_MESG_CPY);
 	}
@@ -595,80 +1176,26 @@ K_ERR kMesgQPeek(K_MESGQ *const kobj, ADDR recvPtr)
 
 K_ERR kMesgQSend(K_MESGQ *const kobj, ADDR const sendPtr, TICK const timeout)
 {
+	return (kMesgQPost_(kobj, sendPtr, 0, timeout, FALSE));
+}
 
-	K_CR_AREA
-
-	if ((kobj == NULL) || (sendPtr == NULL) || (kobj->init == 0))
+K_ERR kMesgQSendV(K_MESGQ *const kobj, K_MESG_FRAG const *const frags,
+		SIZE const nFrags, TICK const timeout)
+{
+	if ((kobj == NULL) || (frags == NULL) || (nFrags == 0))
 	{
 		return (K_ERROR);
 	}
-	if (kIsISR())
-		KFAULT(FAULT_ISR_INVALID_PRIMITVE);
-
-	K_ENTER_CR
-	if (kobj->mesgCnt >= kobj->maxMesg) /*full*/
-	{
-		if (timeout == 0)
-		{
-			K_EXIT_CR
-			return (K_ERR_MESGQ_FULL);
-		}
-
-		if ((timeout > 0) && (timeout < 0xFFFFFFFF))
-			kTimeOut(&kobj->timeoutNode, timeout);
-		{
-#if(K_DEF_MESGQ_ENQ==K_DEF_ENQ_FIFO)
-			kTCBQEnq(&kobj->waitingQueue, runPtr);
-#else
-			kTCBQEnqByPrio(&kobj->waitingQueue, runPtr);
-#endif
-			runPtr->status = SENDING;
-
-			K_PEND_CTXTSWTCH
-			K_EXIT_CR
-			K_ENTER_CR
-			if (runPtr->timeOut)
-			{
-				runPtr->timeOut = FALSE;
-				K_EXIT_CR
-				return (K_ERR_TIMEOUT);
-			}
-		}
-		while (kobj->mesgCnt >= kobj->maxMesg)
-			;
-	}
-	BYTE *dest = kobj->buffer + (kobj->writeIndex * kobj->mesgSize);
-	BYTE const *src = (BYTE const*) sendPtr;
-	SIZE err = 0;
-	CPYQ(dest, src, kobj->mesgSize, err);
-	if (err != kobj->mesgSize)
-	{
-		K_EXIT_CR
-		return (K_ERR_MESG_CPY);
-	}
-	kobj->writeIndex = (kobj->writeIndex + 1) % kobj->maxMesg;
-	kobj->mesgCnt++;
-
-
-
-	/* was empty ?*/
-	if ((kobj->waitingQueue.size > 0) && (kobj->mesgCnt == 1))
+	if (kMesgFragLen_(frags, nFrags) != kobj->mesgSize)
 	{
-		K_TCB *freeTaskPtr;
-		kTCBQDeq(&kobj->waitingQueue, &freeTaskPtr);
-		kTCBQEnq(&readyQueue[freeTaskPtr->priority], freeTaskPtr);
-		freeTaskPtr->status = READY;
-
-		if (freeTaskPtr->priority < runPtr->priority)
-		{
-			K_PEND_CTXTSWTCH
-		}
+		return (K_ERR_INVALID_MESG_SIZE);
 	}
-	K_EXIT_CR
-	return (K_SUCCESS);
+	return (kMesgQPost_(kobj, (ADDR) frags, nFrags, timeout, FALSE));
 }
 
-K_ERR kMesgQRecv(K_MESGQ *const kobj, ADDR recvPtr, TICK const timeout)
+/* recvPtr is the receiving buffer, or a K_MESG_FRAG array when nFrags > 0 */
+static K_ERR kMesgQRecv_(K_MESGQ *const kobj, ADDR const recvPtr,
+		SIZE const nFrags, TICK const timeout)
 {
 	K_CR_AREA
 
@@ -691,26 +1218,35 @@ K_ERR kMesgQRecv(K_MESGQ *const kobj, ADDR recvPtr, TICK const timeout)
 
 		if ((timeout > 0) && (timeout < 0xFFFFFFFF))
 			kTimeOut(&kobj->timeoutNode, timeout);
+		runPtr->mesgBufPtr = recvPtr;
+		runPtr->mesgNFrags = nFrags;
 		do
 		{
-			kTCBQEnq(&kobj->waitingQueue, runPtr);
+			K_MESGQ_WAIT_ENQ(&kobj->receiversQueue, runPtr);
 			runPtr->status = RECEIVING;
+			K_TRACE_BLOCK(kobj)
+			K_CONTENTION_BLOCK(kobj, &kobj->contention, NULL, NULL)
 			K_PEND_CTXTSWTCH
 			K_EXIT_CR
 			K_ENTER_CR
+			if (runPtr->mesgBufPtr == NULL)
+			{
+				/* a sender copied straight into our buffer */
+				K_EXIT_CR
+				return (K_SUCCESS);
+			}
 			if (runPtr->timeOut == TRUE)
 			{
 				runPtr->timeOut = FALSE;
+				runPtr->mesgBufPtr = NULL;
 				K_EXIT_CR
 				return (K_ERR_TIMEOUT);
 			}
-		} while (kobj->mesgCnt == 0)
-			;
+		} while (kobj->mesgCnt == 0);
+		runPtr->mesgBufPtr = NULL;
 	}
-	BYTE const *src = kobj->buffer + (kobj->readIndex * kobj->mesgSize);
-	BYTE *dest = (BYTE*) recvPtr;
-	SIZE err = 0;
-	CPYQ(dest, src, kobj->mesgSize, err);
+	BYTE *src = kobj->buffer + (kobj->readIndex * kobj->mesgSize);
+	SIZE err = kMesgCopy_(recvPtr, nFrags, src, 0, kobj->mesgSize);
 	if (err != kobj->mesgSize)
 	{
 		K_EXIT_CR
@@ -719,28 +1255,320 @@ K_ERR kMesgQRecv(K_MESGQ *const kobj, ADDR recvPtr, TICK const timeout)
 	kobj->readIndex = (kobj->readIndex + 1) % kobj->maxMesg;
 	kobj->mesgCnt--;
 
-	/* was full ? unblock */
-	if ((kobj->waitingQueue.size > 0) && (kobj->mesgCnt == (kobj->maxMesg - 1)))
+	/* a slot is free: unblock the first sender */
+	kMesgQServeSender_(kobj);
+	K_QWM_UPDATE(kobj, kobj->mesgCnt);
+
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kMesgQRecv(K_MESGQ *const kobj, ADDR recvPtr, TICK const timeout)
+{
+	return (kMesgQRecv_(kobj, recvPtr, 0, timeout));
+}
+
+K_ERR kMesgQRecvV(K_MESGQ *const kobj, K_MESG_FRAG const *const frags,
+		SIZE const nFrags, TICK const timeout)
+{
+	if ((kobj == NULL) || (frags == NULL) || (nFrags == 0))
+	{
+		return (K_ERROR);
+	}
+	if (kMesgFragLen_(frags, nFrags) != kobj->mesgSize)
+	{
+		return (K_ERR_INVALID_MESG_SIZE);
+	}
+	return (kMesgQRecv_(kobj, (ADDR) frags, nFrags, timeout));
+}
+
+K_ERR kMesgQJam(K_MESGQ *const kobj, ADDR const sendPtr, TICK timeout)
+{
+	return (kMesgQPost_(kobj, sendPtr, 0, timeout, TRUE));
+}
+
+K_ERR kMesgQGetMesgCount(K_MESGQ *const kobj, UINT32 *const mesgCntPtr)
+{
+	K_CR_AREA
+	if (kobj)
+	{
+		K_ENTER_CR
+		*mesgCntPtr = kobj->mesgCnt;
+		K_EXIT_CR
+		return (K_SUCCESS);
+	}
+	return (K_ERR_OBJ_NULL);
+}
+
+#if (K_DEF_QWATERMARK==ON)
+K_ERR kMesgQSetWatermarks(K_MESGQ *const kobj, SIZE const high,
+		SIZE const low, K_QWM_CALLBACK const callback, ADDR const argPtr)
+{
+	if (kobj == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	return (kQWatermarkSet_(&kobj->watermark, high, low, kobj->maxMesg,
+			callback, argPtr));
+}
+
+#if (K_DEF_TASK_NOTIFY==ON)
+K_ERR kMesgQWatermarkNotify(K_MESGQ *const kobj, TID const taskID,
+		UINT32 const highBits, UINT32 const lowBits)
+{
+	if (kobj == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	return (kQWatermarkNotify_(&kobj->watermark, taskID, highBits, lowBits));
+}
+#endif
+
+K_ERR kMesgQGetQStats(K_MESGQ *const kobj, K_QSTATS *const statsPtr,
+		BOOL const clear)
+{
+	if ((kobj == NULL) || (statsPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	kQWatermarkStats_(&kobj->watermark, statsPtr, kobj->mesgCnt, clear);
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_MESGQ_OVERWRITE==ON)
+K_ERR kMesgQSetOverwrite(K_MESGQ *const kobj, BOOL const overwrite)
+{
+	K_CR_AREA
+	if (kobj == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	kobj->overwrite = overwrite;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kMesgQGetDropCount(K_MESGQ *const kobj, UINT32 *const dropCntPtr,
+		BOOL const clear)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (dropCntPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	*dropCntPtr = kobj->dropCnt;
+	if (clear)
+	{
+		kobj->dropCnt = 0;
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_CONTENTION==ON)
+K_ERR kMesgQGetContention(K_MESGQ *const kobj, K_CONTENTION *const statsPtr,
+		BOOL const clear)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (statsPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	*statsPtr = kobj->contention;
+	if (clear)
+	{
+		kContentionReset(&kobj->contention);
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+#endif
+
+/*******************************************************************************
+ * PRIORITY MESSAGE QUEUE
+ *******************************************************************************
+ * Messages are copied once into fixed slots. Ordering is kept by a binary
+ * min-heap of nodes {priority, sequence, slot} over the slot array, so
+ * insertion and extraction are O(log n) and payloads never move.
+ * Lower number is higher priority, as for tasks; equal priorities are FIFO.
+ * Nodes past the heap end (index >= mesgCnt) carry the free slots.
+ *
+ * A blocked task keeps its own time-out node, on its stack with its buffer,
+ * and the task that serves it cancels that node before readying it.
+ ******************************************************************************/
+
+#if (K_DEF_PMESGQ==ON)
+
+/* a blocked sender or receiver is served: returns its buffer */
+static inline ADDR kPMesgQServe_(K_TCB *const tcbPtr)
+{
+	struct kPMesgQWait *waitPtr = (struct kPMesgQWait*) tcbPtr->mesgBufPtr;
+	kTimeOutCancel(&waitPtr->timeoutNode);
+	return (waitPtr->bufPtr);
+}
+
+/* arms the time-out of a task about to block */
+static inline VOID kPMesgQWaitInit_(struct kPMesgQWait *const waitPtr,
+		K_PMESGQ *const kobj, ADDR const bufPtr, TICK const timeout)
+{
+	waitPtr->bufPtr = bufPtr;
+	waitPtr->queuePtr = kobj;
+	waitPtr->tcbPtr = runPtr;
+	waitPtr->timeoutNode.nextPtr = NULL;
+	waitPtr->timeoutNode.timeout = 0;
+	waitPtr->timeoutNode.kobj = waitPtr;
+	waitPtr->timeoutNode.objectType = PMESGQUEUE;
+	if ((timeout > 0) && (timeout < 0xFFFFFFFF))
+		kTimeOut(&waitPtr->timeoutNode, timeout);
+}
+
+static inline BOOL kPMesgQBefore_(K_PMESGQ_NODE const *const aPtr,
+		K_PMESGQ_NODE const *const bPtr)
+{
+	if (aPtr->prio != bPtr->prio)
 	{
-		K_TCB *freeTaskPtr;
-		kTCBQDeq(&kobj->waitingQueue, &freeTaskPtr);
-		kTCBQEnq(&readyQueue[freeTaskPtr->priority], freeTaskPtr);
-		freeTaskPtr->status = READY;
+		return (aPtr->prio < bPtr->prio);
+	}
+	return ((INT32) (aPtr->seq - bPtr->seq) < 0);
+}
 
-		if (freeTaskPtr->priority < runPtr->priority)
+static VOID kPMesgQSiftUp_(K_PMESGQ *const kobj, SIZE idx)
+{
+	K_PMESGQ_NODE *heap = kobj->heap;
+	K_PMESGQ_NODE node = heap[idx];
+	while (idx > 0)
+	{
+		SIZE parent = (idx - 1) >> 1;
+		if (!kPMesgQBefore_(&node, &heap[parent]))
 		{
-			K_PEND_CTXTSWTCH
+			break;
 		}
+		heap[idx] = heap[parent];
+		idx = parent;
+	}
+	heap[idx] = node;
+}
+
+static VOID kPMesgQSiftDown_(K_PMESGQ *const kobj, SIZE idx)
+{
+	K_PMESGQ_NODE *heap = kobj->heap;
+	K_PMESGQ_NODE node = heap[idx];
+	SIZE n = kobj->mesgCnt;
+	while (TRUE)
+	{
+		SIZE child = (idx << 1) + 1;
+		if (child >= n)
+		{
+			break;
+		}
+		if ((child + 1 < n) && kPMesgQBefore_(&heap[child + 1], &heap[child]))
+		{
+			child++;
+		}
+		if (!kPMesgQBefore_(&heap[child], &node))
+		{
+			break;
+		}
+		heap[idx] = heap[child];
+		idx = child;
+	}
+	heap[idx] = node;
+}
+
+/* copies a message into the free slot parked at the heap end */
+static K_ERR kPMesgQPut_(K_PMESGQ *const kobj, BYTE const *src,
+		PRIO const prio)
+{
+	K_PMESGQ_NODE *node = &kobj->heap[kobj->mesgCnt];
+	BYTE *dest = kobj->buffer + (node->slot * kobj->mesgSize);
+	SIZE err = 0;
+	CPYQ(dest, src, kobj->mesgSize, err);
+	if (err != kobj->mesgSize)
+	{
+		return (K_ERR_MESG_CPY);
+	}
+	node->prio = prio;
+	node->seq = kobj->seq++;
+	kobj->mesgCnt++;
+	kPMesgQSiftUp_(kobj, kobj->mesgCnt - 1);
+	return (K_SUCCESS);
+}
+
+/* copies the top message out; its slot is parked past the heap end */
+static K_ERR kPMesgQGet_(K_PMESGQ *const kobj, BYTE *dest,
+		PRIO *const prioPtr)
+{
+	K_PMESGQ_NODE top = kobj->heap[0];
+	BYTE const *src = kobj->buffer + (top.slot * kobj->mesgSize);
+	SIZE err = 0;
+	CPYQ(dest, src, kobj->mesgSize, err);
+	if (err != kobj->mesgSize)
+	{
+		return (K_ERR_MESG_CPY);
+	}
+	if (prioPtr != NULL)
+	{
+		*prioPtr = top.prio;
 	}
+	kobj->mesgCnt--;
+	kobj->heap[0] = kobj->heap[kobj->mesgCnt];
+	kobj->heap[kobj->mesgCnt] = top;
+	kPMesgQSiftDown_(kobj, 0);
+	return (K_SUCCESS);
+}
 
+K_ERR kPMesgQInit(K_PMESGQ *const kobj, ADDR const buffer,
+		K_PMESGQ_NODE *const nodes, SIZE const mesgSize, SIZE const nMesg)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (buffer == NULL) || (nodes == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	if (mesgSize == 0)
+	{
+		return (K_ERR_INVALID_MESG_SIZE);
+	}
+	if ((nMesg == 0) || (nMesg > 0xFFFF))
+	{
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	K_ENTER_CR
+	kobj->buffer = buffer;
+	kobj->heap = nodes;
+	kobj->mesgSize = mesgSize;
+	kobj->maxMesg = nMesg;
+	kobj->mesgCnt = 0;
+	kobj->seq = 0;
+	for (SIZE i = 0; i < nMesg; i++)
+	{
+		nodes[i].slot = (UINT16) i;
+		nodes[i].prio = 0;
+		nodes[i].seq = 0;
+	}
+	K_ERR err = kListInit(&kobj->sendersQueue, "sendersQueue");
+	err |= kListInit(&kobj->receiversQueue, "receiversQueue");
+	if (err != 0)
+	{
+		K_EXIT_CR
+		return (K_ERROR);
+	}
+	kobj->init = TRUE;
 	K_EXIT_CR
 	return (K_SUCCESS);
 }
 
-K_ERR kMesgQJam(K_MESGQ *const kobj, ADDR const sendPtr, TICK timeout)
+K_ERR kPMesgQSend(K_PMESGQ *const kobj, ADDR const sendPtr, PRIO const prio,
+		TICK const timeout)
 {
 	K_CR_AREA
-	if ((kobj == NULL) || (sendPtr == NULL) || (kobj->init == 0))
+
+	if ((kobj == NULL) || (sendPtr == NULL) || (kobj->init == FALSE))
 	{
 		return (K_ERROR);
 	}
@@ -749,6 +1577,29 @@ K_ERR kMesgQJam(K_MESGQ *const kobj, ADDR const sendPtr, TICK timeout)
 
 	K_ENTER_CR
 
+	/* a receiver waits on an empty queue: hand the message over */
+	if (kobj->receiversQueue.size > 0)
+	{
+		K_TCB *freeRecvPtr;
+		kTCBQDeq(&kobj->receiversQueue, &freeRecvPtr);
+		BYTE *dest = (BYTE*) ((struct kPMesgQWait*)
+				freeRecvPtr->mesgBufPtr)->bufPtr;
+		BYTE const *src = (BYTE const*) sendPtr;
+		SIZE err = 0;
+		CPYQ(dest, src, kobj->mesgSize, err);
+		if (err != kobj->mesgSize)
+		{
+			kTCBQEnq(&kobj->receiversQueue, freeRecvPtr);
+			K_EXIT_CR
+			return (K_ERR_MESG_CPY);
+		}
+		freeRecvPtr->mesgPrio = prio;
+		kPMesgQServe_(freeRecvPtr);
+		kMesgWake_(freeRecvPtr);
+		K_EXIT_CR
+		return (K_SUCCESS);
+	}
+
 	if (kobj->mesgCnt >= kobj->maxMesg) /*full*/
 	{
 		if (timeout == 0)
@@ -757,76 +1608,924 @@ K_ERR kMesgQJam(K_MESGQ *const kobj, ADDR const sendPtr, TICK timeout)
 			return (K_ERR_MESGQ_FULL);
 		}
 
-		if (timeout < 0xFFFFFFFF)
-			kTimeOut(&kobj->timeoutNode, timeout);
+		struct kPMesgQWait wait;
+		kPMesgQWaitInit_(&wait, kobj, sendPtr, timeout);
+		runPtr->mesgBufPtr = &wait;
+		runPtr->mesgPrio = prio;
 		do
 		{
-#if(K_DEF_MESGQ_ENQ==K_DEF_ENQ_FIFO)
-			kTCBQEnq(&kobj->waitingQueue, runPtr);
-#else
-			kTCBQEnqByPrio(&kobj->waitingQueue, runPtr);
-#endif
+			K_MESGQ_WAIT_ENQ(&kobj->sendersQueue, runPtr);
 			runPtr->status = SENDING;
+			K_TRACE_BLOCK(kobj)
 
 			K_PEND_CTXTSWTCH
 			K_EXIT_CR
 			K_ENTER_CR
+			if (runPtr->mesgBufPtr == NULL)
+			{
+				/* a receiver took our message in */
+				K_EXIT_CR
+				return (K_SUCCESS);
+			}
 			if (runPtr->timeOut)
 			{
 				runPtr->timeOut = FALSE;
+				runPtr->mesgBufPtr = NULL;
 				K_EXIT_CR
 				return (K_ERR_TIMEOUT);
 			}
 		} while (kobj->mesgCnt >= kobj->maxMesg);
+		kTimeOutCancel(&wait.timeoutNode);
+		runPtr->mesgBufPtr = NULL;
 	}
-	kobj->readIndex =
-			(kobj->readIndex == 0) ?
-					(kobj->maxMesg - 1) : (kobj->readIndex - 1);
-	BYTE *dest = kobj->buffer + (kobj->readIndex * kobj->mesgSize);
-	BYTE const *src = (BYTE const*) sendPtr;
-	SIZE err = 0;
-	CPYQ(dest, src, kobj->mesgSize, err);
-	if (err != kobj->mesgSize)
+	K_ERR err = kPMesgQPut_(kobj, (BYTE const*) sendPtr, prio);
+	K_EXIT_CR
+	return (err);
+}
+
+K_ERR kPMesgQRecv(K_PMESGQ *const kobj, ADDR recvPtr, PRIO *const prioPtr,
+		TICK const timeout)
+{
+	K_CR_AREA
+
+	if ((kobj == NULL) || (recvPtr == NULL) || (kobj->init == FALSE))
 	{
-		/* restore the read index on failure */
-		kobj->readIndex = (kobj->readIndex + 1) % kobj->maxMesg;
-		K_EXIT_CR
-		return (K_ERR_MESG_CPY);
+		return (K_ERROR);
 	}
-	/*succeded */
-	kobj->mesgCnt++;
+	if (kIsISR())
+		KFAULT(FAULT_ISR_INVALID_PRIMITVE);
+
+	K_ENTER_CR
 
-	/*was empty?*/
-	if ((kobj->mesgCnt == 1) && (kobj->waitingQueue.size > 0))
+	if (kobj->mesgCnt == 0)
 	{
-		K_TCB *freeTaskPtr;
-		kTCBQDeq(&kobj->waitingQueue, &freeTaskPtr);
-		kTCBQEnq(&readyQueue[freeTaskPtr->priority], freeTaskPtr);
-		freeTaskPtr->status = READY;
-		if (freeTaskPtr->priority < runPtr->priority)
+		if (timeout == 0)
 		{
-			K_PEND_CTXTSWTCH
+			K_EXIT_CR
+			return (K_ERR_MESGQ_EMPTY);
 		}
+
+		struct kPMesgQWait wait;
+		kPMesgQWaitInit_(&wait, kobj, recvPtr, timeout);
+		runPtr->mesgBufPtr = &wait;
+		do
+		{
+			K_MESGQ_WAIT_ENQ(&kobj->receiversQueue, runPtr);
+			runPtr->status = RECEIVING;
+			K_TRACE_BLOCK(kobj)
+			K_PEND_CTXTSWTCH
+			K_EXIT_CR
+			K_ENTER_CR
+			if (runPtr->mesgBufPtr == NULL)
+			{
+				/* a sender copied straight into our buffer */
+				if (prioPtr != NULL)
+				{
+					*prioPtr = runPtr->mesgPrio;
+				}
+				K_EXIT_CR
+				return (K_SUCCESS);
+			}
+			if (runPtr->timeOut == TRUE)
+			{
+				runPtr->timeOut = FALSE;
+				runPtr->mesgBufPtr = NULL;
+				K_EXIT_CR
+				return (K_ERR_TIMEOUT);
+			}
+		} while (kobj->mesgCnt == 0);
+		kTimeOutCancel(&wait.timeoutNode);
+		runPtr->mesgBufPtr = NULL;
+	}
+	K_ERR err = kPMesgQGet_(kobj, (BYTE*) recvPtr, prioPtr);
+	if (err != K_SUCCESS)
+	{
+		K_EXIT_CR
+		return (err);
+	}
+	/* a slot is free: take the first blocked sender in */
+	if (kobj->sendersQueue.size > 0)
+	{
+		K_TCB *freeSendPtr;
+		kTCBQDeq(&kobj->sendersQueue, &freeSendPtr);
+		err = kPMesgQPut_(kobj, (BYTE const*) kPMesgQServe_(freeSendPtr),
+				freeSendPtr->mesgPrio);
+		assert(err == K_SUCCESS);
+		kMesgWake_(freeSendPtr);
 	}
 	K_EXIT_CR
 	return (K_SUCCESS);
 }
 
-K_ERR kMesgQGetMesgCount(K_MESGQ *const kobj, UINT32 *const mesgCntPtr)
+K_ERR kPMesgQGetMesgCount(K_PMESGQ *const kobj, UINT32 *const mesgCntPtr)
 {
 	K_CR_AREA
-	if (kobj)
+	if ((kobj == NULL) || (mesgCntPtr == NULL))
 	{
-		K_ENTER_CR
-		*mesgCntPtr = kobj->mesgCnt;
-		K_EXIT_CR
-		return (K_SUCCESS);
+		return (K_ERR_OBJ_NULL);
 	}
-	return (K_ERR_OBJ_NULL);
+	K_ENTER_CR
+	*mesgCntPtr = kobj->mesgCnt;
+	K_EXIT_CR
+	return (K_SUCCESS);
 }
 
+#endif /* K_DEF_PMESGQ */
+
 #endif /*K_DEF_MESGQ*/
 
+/*******************************************************************************
+ * BROADCAST RING
+ *******************************************************************************
+ * One writer, many readers. Every message is written once into a ring of
+ * 2^n slots and stays there until each registered reader has consumed it.
+ * Each reader owns a sequence cursor; the writer owns writeSeq, the next
+ * sequence to be written. Sequence s lives in slot (s & mask).
+ *
+ * Policy K_BCAST_WAIT: the writer blocks while the slowest reader is a full
+ * ring behind. K_BCAST_OVERWRITE: the writer never blocks; a lapped reader
+ * is moved to the oldest message still in the ring and the skipped
+ * messages are accounted in its lost counter.
+ *
+ * A reader that stops reading must kBcastDetach, or with K_BCAST_WAIT it
+ * holds the writer back for good.
+ ******************************************************************************/
+#if (K_DEF_BCAST==ON)
+
+#define K_BCAST_CAPACITY(kobj)  ((kobj)->mask + 1U)
+
+static inline VOID kBcastWake_(K_TCB *const tcbPtr)
+{
+	kTCBQEnq(&readyQueue[tcbPtr->priority], tcbPtr);
+	tcbPtr->status = READY;
+	K_TRACE(K_TRACE_READY, tcbPtr->pid, 0, NULL)
+	K_WAKE_STAMP(tcbPtr)
+	if (tcbPtr->priority < runPtr->priority)
+	{
+		K_PEND_CTXTSWTCH
+	}
+}
+
+/* distance from the slowest reader to the writer */
+static UINT32 kBcastMaxLag_(K_BCAST const *const kobj)
+{
+	UINT32 maxLag = 0;
+	for (K_BCAST_READER *r = kobj->readersPtr; r != NULL; r = r->nextPtr)
+	{
+		UINT32 lag = kobj->writeSeq - r->seq;
+		if (lag > maxLag)
+		{
+			maxLag = lag;
+		}
+	}
+	return (maxLag);
+}
+
+/* a lapped reader (overwrite policy) is moved to the oldest kept message */
+static inline VOID kBcastCatchUp_(K_BCAST_READER *const reader)
+{
+	K_BCAST *kobj = reader->ringPtr;
+	UINT32 lag = kobj->writeSeq - reader->seq;
+	if (lag > K_BCAST_CAPACITY(kobj))
+	{
+		reader->lost += lag - K_BCAST_CAPACITY(kobj);
+		reader->seq = kobj->writeSeq - K_BCAST_CAPACITY(kobj);
+	}
+}
+
+K_ERR kBcastInit(K_BCAST *const kobj, ADDR const buffer, SIZE const mesgSize,
+		SIZE const nMesg, K_BCAST_POLICY const policy)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (buffer == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	if (mesgSize == 0)
+	{
+		return (K_ERR_INVALID_MESG_SIZE);
+	}
+	/* capacity must be a power of two */
+	if ((nMesg == 0) || ((nMesg & (nMesg - 1)) != 0))
+	{
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	K_ENTER_CR
+	kobj->buffer = buffer;
+	kobj->mesgSize = mesgSize;
+	kobj->mask = (UINT32) (nMesg - 1);
+	kobj->writeSeq = 0;
+	kobj->policy = policy;
+	kobj->readersPtr = NULL;
+	K_ERR err = kListInit(&kobj->readersQueue, "bcastReadQ");
+	err |= kListInit(&kobj->writerQueue, "bcastWriteQ");
+	if (err != 0)
+	{
+		K_EXIT_CR
+		return (K_ERROR);
+	}
+	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.timeout = 0;
+	kobj->timeoutNode.kobj = kobj;
+	kobj->timeoutNode.objectType = BCASTWRITER;
+	kobj->init = TRUE;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastAttach(K_BCAST *const kobj, K_BCAST_READER *const reader)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (reader == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	if (kobj->init == FALSE)
+	{
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	K_ENTER_CR
+	/* a reader starts at the next message to be written */
+	reader->ringPtr = kobj;
+	reader->seq = kobj->writeSeq;
+	reader->lost = 0;
+	reader->waitingPtr = NULL;
+	reader->timeoutNode.nextPtr = NULL;
+	reader->timeoutNode.timeout = 0;
+	reader->timeoutNode.kobj = reader;
+	reader->timeoutNode.objectType = BCASTREADER;
+	reader->nextPtr = kobj->readersPtr;
+	kobj->readersPtr = reader;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastDetach(K_BCAST_READER *const reader)
+{
+	K_CR_AREA
+	if (reader == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	K_BCAST *kobj = reader->ringPtr;
+	if (kobj == NULL)
+	{
+		K_EXIT_CR
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	K_BCAST_READER **linkPtr = &kobj->readersPtr;
+	while ((*linkPtr != NULL) && (*linkPtr != reader))
+	{
+		linkPtr = &(*linkPtr)->nextPtr;
+	}
+	if (*linkPtr == NULL)
+	{
+		K_EXIT_CR
+		return (K_ERR_LIST_ITEM_NOT_FOUND);
+	}
+	*linkPtr = reader->nextPtr;
+	/* a task blocked on this cursor returns K_ERR_TIMEOUT */
+	if (reader->waitingPtr != NULL)
+	{
+		K_TCB *tcbPtr = reader->waitingPtr;
+		kTimeOutCancel(&reader->timeoutNode);
+		kTCBQRem(&kobj->readersQueue, &tcbPtr);
+		reader->waitingPtr = NULL;
+		tcbPtr->timeOut = TRUE;
+		kBcastWake_(tcbPtr);
+	}
+	reader->ringPtr = NULL;
+	/* it may have been the slowest reader */
+	if ((kobj->writerQueue.size > 0)
+			&& (kBcastMaxLag_(kobj) < K_BCAST_CAPACITY(kobj)))
+	{
+		K_TCB *freeWriterPtr;
+		kTCBQDeq(&kobj->writerQueue, &freeWriterPtr);
+		kBcastWake_(freeWriterPtr);
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastPublish(K_BCAST *const kobj, ADDR const sendPtr,
+		TICK const timeout)
+{
+	K_CR_AREA
+
+	if ((kobj == NULL) || (sendPtr == NULL) || (kobj->init == FALSE))
+	{
+		return (K_ERROR);
+	}
+
+	K_ENTER_CR
+
+	if (kobj->policy == K_BCAST_WAIT)
+	{
+		while (kBcastMaxLag_(kobj) >= K_BCAST_CAPACITY(kobj)) /*full*/
+		{
+			if (timeout == 0)
+			{
+				K_EXIT_CR
+				return (K_ERR_BCAST_FULL);
+			}
+			if (kIsISR())
+			{
+				KFAULT(FAULT_ISR_INVALID_PRIMITVE);
+			}
+			if ((timeout > 0) && (timeout < 0xFFFFFFFF))
+				kTimeOut(&kobj->timeoutNode, timeout);
+			kTCBQEnq(&kobj->writerQueue, runPtr);
+			runPtr->status = SENDING;
+			K_TRACE_BLOCK(kobj)
+			K_PEND_CTXTSWTCH
+			K_EXIT_CR
+			K_ENTER_CR
+			if (runPtr->timeOut)
+			{
+				runPtr->timeOut = FALSE;
+				K_EXIT_CR
+				return (K_ERR_TIMEOUT);
+			}
+			kTimeOutCancel(&kobj->timeoutNode);
+		}
+	}
+
+	BYTE *dest = kobj->buffer + ((kobj->writeSeq & kobj->mask) * kobj->mesgSize);
+	BYTE const *src = (BYTE const*) sendPtr;
+	SIZE err = 0;
+	CPYQ(dest, src, kobj->mesgSize, err);
+	if (err != kobj->mesgSize)
+	{
+		K_EXIT_CR
+		return (K_ERR_MESG_CPY);
+	}
+	kobj->writeSeq++;
+
+	/* every reader waiting on this sequence is readied in one pass */
+	if (kobj->readersQueue.size > 0)
+	{
+		for (K_BCAST_READER *r = kobj->readersPtr; r != NULL; r = r->nextPtr)
+		{
+			if (r->waitingPtr != NULL)
+			{
+				kTimeOutCancel(&r->timeoutNode);
+				r->waitingPtr = NULL;
+			}
+		}
+		kReadyAllCtxtSwtch(&kobj->readersQueue);
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastAcquire(K_BCAST_READER *const reader, ADDR *const slotPPtr,
+		TICK const timeout)
+{
+	K_CR_AREA
+
+	if ((reader == NULL) || (slotPPtr == NULL) || (reader->ringPtr == NULL))
+	{
+		return (K_ERROR);
+	}
+	K_BCAST *kobj = reader->ringPtr;
+
+	K_ENTER_CR
+	while (reader->seq == kobj->writeSeq) /*nothing new*/
+	{
+		if (timeout == 0)
+		{
+			K_EXIT_CR
+			return (K_ERR_BCAST_EMPTY);
+		}
+		if (kIsISR())
+		{
+			KFAULT(FAULT_ISR_INVALID_PRIMITVE);
+		}
+		if ((timeout > 0) && (timeout < 0xFFFFFFFF))
+			kTimeOut(&reader->timeoutNode, timeout);
+		reader->waitingPtr = runPtr;
+		kTCBQEnq(&kobj->readersQueue, runPtr);
+		runPtr->status = RECEIVING;
+		K_TRACE_BLOCK(kobj)
+		K_PEND_CTXTSWTCH
+		K_EXIT_CR
+		K_ENTER_CR
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_EXIT_CR
+			return (K_ERR_TIMEOUT);
+		}
+	}
+	if (kobj->policy == K_BCAST_OVERWRITE)
+	{
+		kBcastCatchUp_(reader);
+	}
+	*slotPPtr = kobj->buffer + ((reader->seq & kobj->mask) * kobj->mesgSize);
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastRelease(K_BCAST_READER *const reader)
+{
+	K_CR_AREA
+
+	if ((reader == NULL) || (reader->ringPtr == NULL))
+	{
+		return (K_ERROR);
+	}
+	K_BCAST *kobj = reader->ringPtr;
+	K_ERR ret = K_SUCCESS;
+
+	K_ENTER_CR
+	if (reader->seq == kobj->writeSeq)
+	{
+		K_EXIT_CR
+		return (K_ERR_BCAST_EMPTY);
+	}
+	/* the slot was rewritten while held */
+	if ((kobj->writeSeq - reader->seq) > K_BCAST_CAPACITY(kobj))
+	{
+		ret = K_ERR_BCAST_LAGGED;
+		kBcastCatchUp_(reader);
+	}
+	else
+	{
+		reader->seq++;
+	}
+	/* the slowest reader may have moved: let a blocked writer retry */
+	if ((kobj->writerQueue.size > 0)
+			&& (kBcastMaxLag_(kobj) < K_BCAST_CAPACITY(kobj)))
+	{
+		K_TCB *freeWriterPtr;
+		kTCBQDeq(&kobj->writerQueue, &freeWriterPtr);
+		kBcastWake_(freeWriterPtr);
+	}
+	K_EXIT_CR
+	return (ret);
+}
+
+K_ERR kBcastRead(K_BCAST_READER *const reader, ADDR const recvPtr,
+		TICK const timeout)
+{
+	K_CR_AREA
+
+	if (recvPtr == NULL)
+	{
+		return (K_ERROR);
+	}
+	ADDR slotPtr = NULL;
+	K_ERR err = kBcastAcquire(reader, &slotPtr, timeout);
+	if (err != K_SUCCESS)
+	{
+		return (err);
+	}
+	K_BCAST *kobj = reader->ringPtr;
+	/* copy and release with no writer in between */
+	K_ENTER_CR
+	if (kobj->policy == K_BCAST_OVERWRITE)
+	{
+		kBcastCatchUp_(reader);
+	}
+	BYTE *dest = (BYTE*) recvPtr;
+	BYTE const *src = kobj->buffer
+			+ ((reader->seq & kobj->mask) * kobj->mesgSize);
+	SIZE cpy = 0;
+	CPYQ(dest, src, kobj->mesgSize, cpy);
+	if (cpy != kobj->mesgSize)
+	{
+		K_EXIT_CR
+		return (K_ERR_MESG_CPY);
+	}
+	err = kBcastRelease(reader);
+	K_EXIT_CR
+	return (err);
+}
+
+K_ERR kBcastGetLost(K_BCAST_READER *const reader, UINT32 *const lostPtr,
+		BOOL const clear)
+{
+	K_CR_AREA
+	if ((reader == NULL) || (lostPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	*lostPtr = reader->lost;
+	if (clear)
+	{
+		reader->lost = 0;
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+#endif /* K_DEF_BCAST */
+
+/*******************************************************************************
+ * SNAPSHOT CHANNEL (LATEST VALUE)
+ *******************************************************************************
+ * Three buffers and a version number. Version v is kept in buffer (v % 3).
+ * The writer fills buffer (v+1) % 3, which is neither the published one nor
+ * the one published before it, and then publishes v+1. It never blocks and
+ * never masks interrupts.
+ *
+ * A reader copies buffer (v % 3) and checks the version again: the buffer
+ * can only have been rewritten if two publishes happened meanwhile, and then
+ * the copy is retried. A reader that preempts the writer sees a stable
+ * buffer, so a retry only happens when the writer preempts the reader.
+ ******************************************************************************/
+#if (K_DEF_SNAP==ON)
+
+#define K_SNAP_NBUF (3U)
+
+K_ERR kSnapInit(K_SNAP *const kobj, ADDR const buffer, SIZE const mesgSize)
+{
+	if ((kobj == NULL) || (buffer == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	if (mesgSize == 0)
+	{
+		return (K_ERR_INVALID_MESG_SIZE);
+	}
+	kobj->buffer = buffer;
+	kobj->mesgSize = mesgSize;
+	kobj->version = 0;
+	kobj->writing = 0;
+	kobj->init = TRUE;
+	DMB
+	return (K_SUCCESS);
+}
+
+K_ERR kSnapWrite(K_SNAP *const kobj, ADDR const sendPtr)
+{
+	if ((kobj == NULL) || (sendPtr == NULL) || (kobj->init == FALSE))
+	{
+		return (K_ERROR);
+	}
+	/* one writer at a time: a concurrent one is turned away, not blocked */
+	do
+	{
+		if (kLdrEx(&kobj->writing) != 0U)
+		{
+			kClrEx();
+			return (K_ERR_SNAP_BUSY);
+		}
+	} while (!kStrEx(&kobj->writing, 0U, 1U));
+
+	UINT32 next = kobj->version + 1U;
+	if (next == 0U)
+	{
+		next = 1U; /* 0 means never written */
+	}
+	BYTE *dest = kobj->buffer + ((next % K_SNAP_NBUF) * kobj->mesgSize);
+	SIZE err = 0;
+	CPYQ(dest, sendPtr, kobj->mesgSize, err);
+	if (err != kobj->mesgSize)
+	{
+		kobj->writing = 0U;
+		return (K_ERR_MESG_CPY);
+	}
+	DMB
+	kobj->version = next;
+	DMB
+	kobj->writing = 0U;
+	return (K_SUCCESS);
+}
+
+K_ERR kSnapRead(K_SNAP *const kobj, ADDR const recvPtr,
+		UINT32 *const versionPtr)
+{
+	if ((kobj == NULL) || (recvPtr == NULL) || (kobj->init == FALSE))
+	{
+		return (K_ERROR);
+	}
+	UINT32 ver;
+	UINT32 verAfter;
+	do
+	{
+		ver = kobj->version;
+		DMB
+		if (ver == 0U)
+		{
+			return (K_ERR_SNAP_EMPTY);
+		}
+		if ((versionPtr != NULL) && (*versionPtr == ver))
+		{
+			return (K_ERR_SNAP_SEEN);
+		}
+		BYTE const *src = kobj->buffer
+				+ ((ver % K_SNAP_NBUF) * kobj->mesgSize);
+		SIZE err = 0;
+		CPYQ(recvPtr, src, kobj->mesgSize, err);
+		if (err != kobj->mesgSize)
+		{
+			return (K_ERR_MESG_CPY);
+		}
+		DMB
+		verAfter = kobj->version;
+	} while ((verAfter - ver) > 1U);
+
+	if (versionPtr != NULL)
+	{
+		*versionPtr = ver;
+	}
+	return (K_SUCCESS);
+}
+
+UINT32 kSnapVersion(K_SNAP *const kobj)
+{
+	return ((kobj != NULL) ? kobj->version : 0U);
+}
+
+#endif /* K_DEF_SNAP */
+
+/*******************************************************************************
+ * RENDEZVOUS (SEND-RECEIVE-REPLY)
+ *******************************************************************************
+ * A client calls with a request and stays blocked until the server replies.
+ * Request and reply are passed by reference: the call record lives on the
+ * client stack and the client mesgBufPtr points to it while it is blocked.
+ *
+ * If the server is already blocked on kRdvAccept, the call hands the request
+ * over and the client blocks: one switch, to the server. The reply readies
+ * the client: one switch back. Otherwise the client waits on the callers
+ * queue, by priority, until the server accepts it.
+ *
+ * While handling a call the server runs at its client priority if that is
+ * higher, and at the priority of the first queued caller if that is higher
+ * still; a caller that times out no longer counts. The reply gives back the
+ * priority the server had when it accepted, but not below the ceiling
+ * mutexes it still holds.
+ ******************************************************************************/
+#if (K_DEF_RDV==ON)
+
+/* Sets the server priority from the call it handles (none after the reply).
+ * Only the raise this rendezvous made is ever dropped: if something else
+ * (a mutex) changed the priority since, it is only raised further. */
+VOID kRdvServerPrio(K_RDV *const kobj, K_TCB *const serverPtr)
+{
+	PRIO prio = kobj->savedPrio;
+	if (kobj->clientPtr != NULL)
+	{
+		if (kobj->clientPtr->priority < prio)
+		{
+			prio = kobj->clientPtr->priority;
+		}
+		if ((kobj->callersQueue.size > 0)
+				&& (kTCBQPeek(&kobj->callersQueue)->priority < prio))
+		{
+			prio = kTCBQPeek(&kobj->callersQueue)->priority;
+		}
+	}
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	if (serverPtr->ceilPrio < prio)
+	{
+		prio = serverPtr->ceilPrio;
+	}
+#endif
+	if ((serverPtr->priority == kobj->boostPrio)
+			|| (prio < serverPtr->priority))
+	{
+		kSchSetPrio(serverPtr, prio);
+		kobj->boostPrio = prio;
+	}
+}
+
+/* the server takes a client call; returns the request */
+static inline ADDR kRdvTake_(K_RDV *const kobj, K_TCB *const serverPtr,
+		K_TCB *const clientPtr)
+{
+	kobj->ownerPtr = serverPtr;
+	kobj->clientPtr = clientPtr;
+	kobj->savedPrio = serverPtr->priority;
+	kobj->boostPrio = serverPtr->priority;
+	kRdvServerPrio(kobj, serverPtr);
+	/* from now on the client only waits for the reply */
+	clientPtr->status = RECEIVING;
+	return (((struct kRdvCall*) clientPtr->mesgBufPtr)->reqPtr);
+}
+
+K_ERR kRdvInit(K_RDV *const kobj)
+{
+	K_CR_AREA
+
+	if (kobj == NULL)
+	{
+		KFAULT(FAULT_NULL_OBJ);
+		return (K_ERROR);
+	}
+	K_ENTER_CR
+	kobj->serverPtr = NULL;
+	kobj->ownerPtr = NULL;
+	kobj->clientPtr = NULL;
+	kobj->savedPrio = 0;
+	kobj->boostPrio = 0;
+	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.timeout = 0;
+	kobj->timeoutNode.kobj = kobj;
+	kobj->timeoutNode.objectType = RDVSERVER;
+	if (kListInit(&kobj->callersQueue, "rdvCallQ") != K_SUCCESS)
+	{
+		K_EXIT_CR
+		return (K_ERROR);
+	}
+	kobj->init = TRUE;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kRdvCall(K_RDV *const kobj, ADDR const reqPtr, ADDR *const replyPPtr,
+		TICK const timeout)
+{
+	K_CR_AREA
+
+	if (kobj == NULL)
+	{
+		KFAULT(FAULT_NULL_OBJ);
+		return (K_ERROR);
+	}
+	if (!kobj->init)
+	{
+		KFAULT(FAULT_OBJ_NOT_INIT);
+		return (K_ERROR);
+	}
+	if (kIsISR())
+	{
+		KFAULT(FAULT_ISR_INVALID_PRIMITVE);
+	}
+
+	struct kRdvCall call;
+	call.reqPtr = reqPtr;
+	call.replyPtr = NULL;
+	call.rdvPtr = kobj;
+	call.tcbPtr = runPtr;
+	call.timeoutNode.nextPtr = NULL;
+	call.timeoutNode.timeout = 0;
+	call.timeoutNode.kobj = &call;
+	call.timeoutNode.objectType = RDVCALLER;
+
+	K_ENTER_CR
+	if (kobj->ownerPtr == runPtr)
+	{
+		/* the server cannot call itself */
+		K_EXIT_CR
+		return (K_ERR_RDV_BUSY);
+	}
+	runPtr->mesgBufPtr = &call;
+	if (kobj->serverPtr != NULL)
+	{
+		/* the server is waiting: hand the request over */
+		K_TCB *serverPtr = kobj->serverPtr;
+		kobj->serverPtr = NULL;
+		kTimeOutCancel(&kobj->timeoutNode);
+		*((ADDR*) serverPtr->mesgBufPtr) = kRdvTake_(kobj, serverPtr, runPtr);
+		kMesgWake_(serverPtr);
+	}
+	else
+	{
+		if (timeout == 0)
+		{
+			runPtr->mesgBufPtr = NULL;
+			K_EXIT_CR
+			return (K_ERR_RDV_NO_SERVER);
+		}
+		if ((timeout > 0) && (timeout < 0xFFFFFFFF))
+		{
+			kTimeOut(&call.timeoutNode, timeout);
+		}
+		kTCBQEnqByPrio(&kobj->callersQueue, runPtr);
+		if (kobj->ownerPtr != NULL)
+		{
+			/* the server may be busy with a lower priority client */
+			kRdvServerPrio(kobj, kobj->ownerPtr);
+		}
+		runPtr->status = SENDING;
+		K_TRACE_BLOCK(kobj)
+	}
+	do
+	{
+		K_PEND_CTXTSWTCH
+		K_EXIT_CR
+		K_ENTER_CR
+		if (runPtr->timeOut)
+		{
+			/* not accepted in time */
+			runPtr->timeOut = FALSE;
+			runPtr->mesgBufPtr = NULL;
+			K_EXIT_CR
+			return (K_ERR_TIMEOUT);
+		}
+	} while (runPtr->mesgBufPtr != NULL);
+	K_EXIT_CR
+
+	if (replyPPtr != NULL)
+	{
+		*replyPPtr = call.replyPtr;
+	}
+	return (K_SUCCESS);
+}
+
+K_ERR kRdvAccept(K_RDV *const kobj, ADDR *const reqPPtr, TICK const timeout)
+{
+	K_CR_AREA
+
+	if (kobj == NULL || reqPPtr == NULL)
+	{
+		KFAULT(FAULT_NULL_OBJ);
+		return (K_ERROR);
+	}
+	if (!kobj->init)
+	{
+		KFAULT(FAULT_OBJ_NOT_INIT);
+		return (K_ERROR);
+	}
+	if (kIsISR())
+	{
+		KFAULT(FAULT_ISR_INVALID_PRIMITVE);
+	}
+	K_ENTER_CR
+	if ((kobj->ownerPtr != NULL) || (kobj->serverPtr != NULL))
+	{
+		/* a call is not replied yet, or another server is waiting */
+		K_EXIT_CR
+		return (K_ERR_RDV_BUSY);
+	}
+	if (kobj->callersQueue.size > 0)
+	{
+		K_TCB *clientPtr;
+		kTCBQDeq(&kobj->callersQueue, &clientPtr);
+		kTimeOutCancel(&((struct kRdvCall*) clientPtr->mesgBufPtr)->timeoutNode);
+		*reqPPtr = kRdvTake_(kobj, runPtr, clientPtr);
+		K_EXIT_CR
+		return (K_SUCCESS);
+	}
+	if (timeout == 0)
+	{
+		K_EXIT_CR
+		return (K_ERR_RDV_NO_CALLER);
+	}
+	if ((timeout > 0) && (timeout < 0xFFFFFFFF))
+	{
+		kTimeOut(&kobj->timeoutNode, timeout);
+	}
+	kobj->serverPtr = runPtr;
+	runPtr->mesgBufPtr = reqPPtr;
+	runPtr->status = RECEIVING;
+	K_TRACE_BLOCK(kobj)
+	do
+	{
+		K_PEND_CTXTSWTCH
+		K_EXIT_CR
+		K_ENTER_CR
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			runPtr->mesgBufPtr = NULL;
+			K_EXIT_CR
+			return (K_ERR_TIMEOUT);
+		}
+	} while (runPtr->mesgBufPtr != NULL);
+	/* a client handed its request over and is waiting for the reply */
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kRdvReply(K_RDV *const kobj, ADDR const replyPtr)
+{
+	K_CR_AREA
+
+	if (kobj == NULL)
+	{
+		KFAULT(FAULT_NULL_OBJ);
+		return (K_ERROR);
+	}
+	K_ENTER_CR
+	if (kobj->ownerPtr != runPtr)
+	{
+		/* only the server that accepted the call replies */
+		K_EXIT_CR
+		return (K_ERROR);
+	}
+	K_TCB *clientPtr = kobj->clientPtr;
+	((struct kRdvCall*) clientPtr->mesgBufPtr)->replyPtr = replyPtr;
+	kobj->ownerPtr = NULL;
+	kobj->clientPtr = NULL;
+	kRdvServerPrio(kobj, runPtr);
+	kMesgWake_(clientPtr);
+	/* back at its own priority, the server may not be the highest anymore */
+	if (kSchNeedReschedule(runPtr))
+	{
+		K_PEND_CTXTSWTCH
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+#endif /* K_DEF_RDV */
+
 #if (K_DEF_PDQ == ON)
 
 /******************************************************************************
@@ -0,0 +1,138 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  Module           : PC Sampling Profiler
+ *  Depends on       : Scheduler
+ *  Provides to      : Application
+ *  Public API       : Yes
+ *
+ *  In this unit:
+ *  				 Statistical PC sampling
+ *
+ *****************************************************************************/
+
+/*******************************************************************************
+ * On every tick (or every interrupt of a faster timer calling kPcSampleISR)
+ * the PC stacked by the interrupted task is counted against the running
+ * task, in a 2^K_DEF_PCSAMPLE_SHIFT-byte address range.
+ *
+ * The interrupted context is a task when no other exception is active
+ * (ICSR.RETTOBASE); its frame is then on the process stack, with the PC at
+ * PSP+24. A sample that interrupted another handler only counts in
+ * nHandler.
+ *
+ * Counts live in an open-addressing hash table keyed by {range, task}.
+ * A sample that finds no free slot within a few probes counts in nDropped.
+ * The table is dumped as is:
+ *
+ *   dump binary memory pcs.bin &kPcSample (&kPcSample + 1)
+ *
+ * and tools/kpcprof.py symbolizes it against the ELF, per function and per
+ * task, or as folded stacks for a flame graph.
+ ******************************************************************************/
+
+#define K_CODE
+#include "kconfig.h"
+#include "kobjs.h"
+#include "kinternals.h"
+#include "ksch.h"
+#include "kpcsample.h"
+
+#if (K_DEF_PCSAMPLE==ON)
+
+#if ((K_DEF_PCSAMPLE_SLOTS & (K_DEF_PCSAMPLE_SLOTS - 1)) != 0)
+#error "K_DEF_PCSAMPLE_SLOTS must be a power of two"
+#endif
+
+#define K_PCSAMPLE_MAGIC  (0x4B504353) /* "KPCS" */
+#define K_PCSAMPLE_PROBES (8)
+#define K_PCSAMPLE_PC     (6) /* stacked PC, in words above the PSP */
+
+K_PCSAMPLE_BUF kPcSample;
+
+VOID kPcSampleInit(VOID)
+{
+	kPcSample.magic = K_PCSAMPLE_MAGIC;
+	kPcSample.nSlots = K_DEF_PCSAMPLE_SLOTS;
+	kPcSample.shift = K_DEF_PCSAMPLE_SHIFT;
+	kPcSample.nTasks = NTHREADS;
+	kPcSample.on = TRUE;
+}
+
+VOID kPcSampleISR(VOID)
+{
+	if ((!kPcSample.on) || (runPtr == NULL))
+	{
+		return;
+	}
+	kPcSample.nSamples += 1U;
+	if (!(SCB->ICSR & SCB_ICSR_RETTOBASE_Msk))
+	{
+		kPcSample.nHandler += 1U;
+		return;
+	}
+	UINT32 const *framePtr = (UINT32 const*) __get_PSP();
+	UINT32 addr = framePtr[K_PCSAMPLE_PC]
+			& ~((1U << K_DEF_PCSAMPLE_SHIFT) - 1U);
+	PID pid = runPtr->pid;
+	kPcSample.taskSamples[pid] += 1U;
+
+	/* Fibonacci hash of the range, mixed with the task */
+	UINT32 idx = (((addr >> K_DEF_PCSAMPLE_SHIFT) ^ ((UINT32) pid << 24))
+			* 2654435761U) >> 16;
+	for (UINT32 n = 0; n < K_PCSAMPLE_PROBES; n++)
+	{
+		K_PCSAMPLE_SLOT *slotPtr = &kPcSample.slot[(idx + n)
+				& (K_DEF_PCSAMPLE_SLOTS - 1U)];
+		if (slotPtr->addr == 0U)
+		{
+			slotPtr->addr = addr;
+			slotPtr->pid = pid;
+			slotPtr->count = 1U;
+			return;
+		}
+		if ((slotPtr->addr == addr) && (slotPtr->pid == pid))
+		{
+			if (slotPtr->count < 0xFFFFU)
+			{
+				slotPtr->count += 1U;
+			}
+			return;
+		}
+	}
+	kPcSample.nDropped += 1U;
+}
+
+VOID kPcSampleStart(VOID)
+{
+	kPcSample.on = TRUE;
+}
+
+VOID kPcSampleStop(VOID)
+{
+	kPcSample.on = FALSE;
+}
+
+VOID kPcSampleClear(VOID)
+{
+	K_CR_AREA
+	K_ENTER_CR
+	kPcSample.nSamples = 0;
+	kPcSample.nHandler = 0;
+	kPcSample.nDropped = 0;
+	for (SIZE i = 0; i < NTHREADS; i++)
+	{
+		kPcSample.taskSamples[i] = 0;
+	}
+	for (SIZE i = 0; i < K_DEF_PCSAMPLE_SLOTS; i++)
+	{
+		kPcSample.slot[i].addr = 0;
+		kPcSample.slot[i].count = 0;
+	}
+	K_EXIT_CR
+}
+
+#endif /* K_DEF_PCSAMPLE */
@@ -0,0 +1,196 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  Module           : Service Profiling
+ *  Depends on       : Scheduler
+ *  Provides to      : Application
+ *  Public API       : Yes
+ *
+ *  In this unit:
+ *  				 Per-service cycle statistics
+ *  				 Interrupt-masked windows
+ *
+ *****************************************************************************/
+
+/*******************************************************************************
+ * The wrappers in kprof.h bracket each service call with kProfEnter and
+ * kProfExit. The call context lives on the caller stack, so nested calls
+ * (e.g. a service called from a bus callback) are measured separately.
+ *
+ * A call during which the caller was switched out (it blocked or was
+ * preempted by a task) is counted in nSwitched but kept out of min, max
+ * and total: those would measure the other tasks, not the service.
+ * Interrupts served during a call are included.
+ *
+ * Every outermost K_EXIT_CR closes a masked window. The longest one is
+ * kept with the address it was closed from, and the longest one inside
+ * each service goes to that service maskMax.
+ ******************************************************************************/
+
+#define K_CODE
+#include "kconfig.h"
+#include "kobjs.h"
+#include "kinternals.h"
+#include "ksch.h"
+#include "kprof.h"
+
+#if (K_DEF_PROFILE==ON)
+
+#define K_PROF_NAME_(fn) #fn,
+
+static STRING const profNames_[K_PROF_NSVC] =
+{ K_PROF_SVCS(K_PROF_NAME_) };
+
+static K_PROF_STAT profStats_[K_PROF_NSVC];
+
+UINT32 kProfMaskStamp;
+static UINT32 profMaskMax_;
+static ADDR profMaskWhere_;
+
+VOID kProfEnter(K_PROF_CTX *const ctxPtr)
+{
+	if (!kIsISR())
+	{
+		ctxPtr->runCnt = runPtr->runCnt;
+		ctxPtr->maskMax = runPtr->maskMax;
+		runPtr->maskMax = 0;
+	}
+	ctxPtr->stamp = K_CYCLE_CNT;
+}
+
+VOID kProfExit(K_PROF_SVC const svc, K_PROF_CTX *const ctxPtr)
+{
+	UINT32 cycles = K_CYCLE_CNT - ctxPtr->stamp;
+	UINT32 maskMax = 0;
+	BOOL switched = FALSE;
+
+	if (!kIsISR())
+	{
+		maskMax = runPtr->maskMax;
+		switched = (runPtr->runCnt != ctxPtr->runCnt);
+		/* an enclosing call sees the longest window of both */
+		if (ctxPtr->maskMax > runPtr->maskMax)
+		{
+			runPtr->maskMax = ctxPtr->maskMax;
+		}
+	}
+	K_CR_AREA
+	K_ENTER_CR
+	K_PROF_STAT *statPtr = &profStats_[svc];
+	if (maskMax > statPtr->maskMax)
+	{
+		statPtr->maskMax = maskMax;
+	}
+	if (switched)
+	{
+		statPtr->nSwitched += 1U;
+	}
+	else
+	{
+		if ((statPtr->count == 0U) || (cycles < statPtr->min))
+		{
+			statPtr->min = cycles;
+		}
+		if (cycles > statPtr->max)
+		{
+			statPtr->max = cycles;
+		}
+		statPtr->total += cycles;
+		statPtr->count += 1U;
+	}
+	K_EXIT_CR
+}
+
+/* called with interrupts still masked */
+VOID kProfMaskEnd(ADDR const where)
+{
+	UINT32 cycles = K_CYCLE_CNT - kProfMaskStamp;
+	if (cycles > profMaskMax_)
+	{
+		profMaskMax_ = cycles;
+		profMaskWhere_ = where;
+	}
+	if ((runPtr != NULL) && !kIsISR() && (cycles > runPtr->maskMax))
+	{
+		runPtr->maskMax = cycles;
+	}
+}
+
+K_ERR kProfGet(K_PROF_SVC const svc, K_PROF_STAT *const statPtr,
+		BOOL const clear)
+{
+	if (statPtr == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	if (svc >= K_PROF_NSVC)
+	{
+		return (K_ERROR);
+	}
+	K_CR_AREA
+	K_ENTER_CR
+	*statPtr = profStats_[svc];
+	if (clear)
+	{
+		profStats_[svc].count = 0;
+		profStats_[svc].nSwitched = 0;
+		profStats_[svc].min = 0;
+		profStats_[svc].max = 0;
+		profStats_[svc].total = 0;
+		profStats_[svc].maskMax = 0;
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+UINT32 kProfGetMask(ADDR *const wherePtr, BOOL const clear)
+{
+	K_CR_AREA
+	K_ENTER_CR
+	UINT32 cycles = profMaskMax_;
+	if (wherePtr != NULL)
+	{
+		*wherePtr = profMaskWhere_;
+	}
+	if (clear)
+	{
+		profMaskMax_ = 0;
+		profMaskWhere_ = NULL;
+	}
+	K_EXIT_CR
+	return (cycles);
+}
+
+VOID kProfDump(K_PROF_PRINTF const printFn)
+{
+	if (printFn == NULL)
+	{
+		return;
+	}
+	printFn("%-22s %8s %8s %8s %8s %8s %8s\r\n", "service", "calls",
+			"switched", "min", "avg", "max", "masked");
+	for (UINT32 svc = 0; svc < K_PROF_NSVC; svc++)
+	{
+		K_PROF_STAT stat;
+		kProfGet((K_PROF_SVC) svc, &stat, FALSE);
+		if ((stat.count == 0U) && (stat.nSwitched == 0U))
+		{
+			continue;
+		}
+		UINT32 avg = (stat.count > 0U) ?
+				(UINT32) (stat.total / stat.count) : 0U;
+		printFn("%-22s %8lu %8lu %8lu %8lu %8lu %8lu\r\n", profNames_[svc],
+				(unsigned long) stat.count, (unsigned long) stat.nSwitched,
+				(unsigned long) stat.min, (unsigned long) avg,
+				(unsigned long) stat.max, (unsigned long) stat.maskMax);
+	}
+	ADDR where = NULL;
+	UINT32 cycles = kProfGetMask(&where, FALSE);
+	printFn("longest masked window: %lu cycles, ending at %p\r\n",
+			(unsigned long) cycles, where);
+}
+
+#endif /* K_DEF_PROFILE */
@@ -25,6 +25,11 @@
 #include "ktimer.h"
 #include "kinternals.h"
 #include "ksch.h"
+#include "ktrace.h"
+#include "klog.h"
+#include "kstats.h"
+#include "kpcsample.h"
+#include "kprof.h"
 
 /*****************************************************************************/
 
@@ -196,6 +201,8 @@ K_ERR kReadyCtxtSwtch(K_TCB *const tcbPtr)
 	if (kTCBQEnq(&readyQueue[tcbPtr->priority], tcbPtr) == K_SUCCESS)
 	{
 		tcbPtr->status = READY;
+		K_TRACE(K_TRACE_READY, tcbPtr->pid, 0, NULL)
+		K_WAKE_STAMP(tcbPtr)
 #ifdef INSTANT_PREEMPT_LOWER_PRIO
 		if (READY_HIGHER_PRIO(tcbPtr))
 		{
@@ -211,6 +218,45 @@ K_ERR kReadyCtxtSwtch(K_TCB *const tcbPtr)
 	return (K_ERROR);
 }
 
+/* moves every task waiting on a queue to the ready queues in one pass.
+ * the ready bitmask is updated once, and a single preemption decision is
+ * taken for the whole batch. the running task is put back on READY by the
+ * context switch, not here. returns the number of tasks readied. */
+UINT32 kReadyAllCtxtSwtch(K_TCBQ *const waitQPtr)
+{
+	if (IS_NULL_PTR(waitQPtr))
+	{
+		kErrHandler(FAULT_NULL_OBJ);
+		return (0);
+	}
+	K_CR_AREA
+	K_ENTER_CR
+	UINT32 mask = 0;
+	UINT32 nReady = 0;
+	K_LISTNODE *nodePtr = NULL;
+	while (kListRemoveHead(waitQPtr, &nodePtr) == K_SUCCESS)
+	{
+		K_TCB *tcbPtr = K_LIST_GET_TCB_NODE(nodePtr, K_TCB);
+		kListAddTail(&readyQueue[tcbPtr->priority], &(tcbPtr->tcbNode));
+		tcbPtr->status = READY;
+		K_TRACE(K_TRACE_READY, tcbPtr->pid, 0, waitQPtr)
+		K_WAKE_STAMP(tcbPtr)
+		mask |= 1U << tcbPtr->priority;
+		nReady += 1U;
+	}
+	if (mask != 0U)
+	{
+		readyQBitMask |= mask;
+		PRIO topPrio = (PRIO) __getReadyPrio(mask & -mask);
+		if (topPrio < runPtr->priority)
+		{
+			K_PEND_CTXTSWTCH
+		}
+	}
+	K_EXIT_CR
+	return (nReady);
+}
+
 K_ERR kReadyQDeq(K_TCB **const tcbPPtr, PRIO priority)
 {
 
@@ -256,9 +302,9 @@ static K_ERR kInitStack_(INT *const stackAddrPtr, UINT32 const stackSize,
 	/*stack painting*/
 	for (UINT32 j = 17; j < stackSize; j++)
 	{
-		stackAddrPtr[stackSize - j] = (INT) 0xBADC0FFE;
+		stackAddrPtr[stackSize - j] = (INT) K_STACK_PAINT;
 	}
-	stackAddrPtr[0] = 0x0BADC0DE;
+	stackAddrPtr[0] = (INT) K_STACK_SENTINEL;
 	return (K_SUCCESS);
 }
 
@@ -272,6 +318,15 @@ K_ERR kInitTcb_(TASKENTRY const taskFuncPtr, INT *const stackAddrPtr,
 		tcbs[pPid].stackSize = stackSize;
 		tcbs[pPid].status = READY;
 		tcbs[pPid].pid = pPid;
+#if (K_DEF_TASK_NOTIFY==ON)
+		tcbs[pPid].notifyVal = 0;
+		tcbs[pPid].notifyPend = FALSE;
+		tcbs[pPid].notifyWait = FALSE;
+		tcbs[pPid].notifyTimeoutNode.nextPtr = NULL;
+		tcbs[pPid].notifyTimeoutNode.timeout = 0;
+		tcbs[pPid].notifyTimeoutNode.kobj = &tcbs[pPid];
+		tcbs[pPid].notifyTimeoutNode.objectType = TASKNOTIFY;
+#endif
 
 		return (K_SUCCESS);
 	}
@@ -298,6 +353,10 @@ K_ERR kCreateTask(TASKENTRY const taskFuncPtr, STRING taskName, TID const id,
 
 		tcbs[pPid].priority = idleTaskPrio;
 		tcbs[pPid].realPrio = idleTaskPrio;
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+		tcbs[pPid].ceilPrio = idleTaskPrio;
+		tcbs[pPid].ceilHeldPtr = NULL;
+#endif
 		tcbs[pPid].taskName = "IdleTask";
 		tcbs[pPid].uPid = IDLETASK_ID;
 		tcbs[pPid].runToCompl = FALSE;
@@ -313,6 +372,10 @@ K_ERR kCreateTask(TASKENTRY const taskFuncPtr, STRING taskName, TID const id,
 
 		tcbs[pPid].priority = 0;
 		tcbs[pPid].realPrio = 0;
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+		tcbs[pPid].ceilPrio = 0;
+		tcbs[pPid].ceilHeldPtr = NULL;
+#endif
 		tcbs[pPid].taskName = "TimHandlerTask";
 		tcbs[pPid].uPid = TIMHANDLER_ID;
 		tcbs[pPid].runToCompl = TRUE;
@@ -340,6 +403,10 @@ K_ERR kCreateTask(TASKENTRY const taskFuncPtr, STRING taskName, TID const id,
 
 		tcbs[pPid].priority = priority;
 		tcbs[pPid].realPrio = priority;
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+		tcbs[pPid].ceilPrio = priority;
+		tcbs[pPid].ceilHeldPtr = NULL;
+#endif
 		tcbs[pPid].taskName = taskName;
 		tcbs[pPid].lastWakeTime = 0;
 #if(K_DEF_SCH_TSLICE==ON)
@@ -371,7 +438,9 @@ UINT32 kEnterCR(VOID)
 		asm volatile("DSB");
 		asm volatile ("CPSID I");
 		asm volatile("ISB");
-
+#if (K_DEF_PROFILE==ON)
+		kProfMaskStamp = K_CYCLE_CNT;
+#endif
 		return (crState);
 	}
 	asm volatile("DSB");
@@ -381,6 +450,13 @@ UINT32 kEnterCR(VOID)
 VOID kExitCR(UINT32 crState)
 {
 	asm volatile("DSB");
+#if (K_DEF_PROFILE==ON)
+	if (crState == 0)
+	{
+		/* the outermost exit unmasks */
+		kProfMaskEnd(__builtin_return_address(0));
+	}
+#endif
 	__set_PRIMASK(crState);
 	asm volatile ("ISB");
 
@@ -436,6 +512,20 @@ void kInit(void)
 		kErrHandler(FAULT_KERNEL_VERSION);
 	kInitQueues_();
 	kInitRunTime_();
+#if ((K_DEF_TRACE==ON) || (K_DEF_LATENCY==ON) || (K_DEF_PROFILE==ON) \
+		|| (K_DEF_CONTENTION==ON) || (K_DEF_LOG==ON) || (K_DEF_CPULOAD==ON) \
+		|| (K_DEF_STATS==ON))
+	K_CYCLE_CNT_EN
+#endif
+#if (K_DEF_TRACE==ON)
+	kTraceInit();
+#endif
+#if (K_DEF_LOG==ON)
+	kLogInit();
+#endif
+#if (K_DEF_PCSAMPLE==ON)
+	kPcSampleInit();
+#endif
 	highestPrio = tcbs[0].priority;
 	for (int i = 0; i < NTHREADS; i++)
 	{
@@ -531,6 +621,90 @@ static BOOL kSleepHandle_(VOID)
 
 }
 
+#if (K_DEF_CPULOAD==ON)
+#if ((K_DEF_CPULOAD_WIN_SHORT > K_DEF_CPULOAD_WIN_LONG) \
+		|| (K_DEF_CPULOAD_WIN_MID > K_DEF_CPULOAD_WIN_LONG))
+#error "K_DEF_CPULOAD_WIN_LONG must be the longest CPU load window"
+#endif
+
+/* one-second samples, the last K_DEF_CPULOAD_WIN_LONG kept */
+UINT32 volatile kIdleCycles;
+static UINT32 loadStamp_;
+static UINT32 loadIdleStamp_;
+static UINT32 loadIdx_;
+static UINT32 loadCnt_;
+static UINT16 loadPeak_;
+static UINT16 loadSamples_[K_DEF_CPULOAD_WIN_LONG];
+
+static inline VOID kCpuLoadSample_(VOID)
+{
+	UINT32 now = K_CYCLE_CNT;
+	UINT32 elapsed = now - loadStamp_;
+	if (elapsed < SystemCoreClock)
+	{
+		return;
+	}
+	UINT32 idle = kIdleCycles - loadIdleStamp_;
+	loadStamp_ = now;
+	loadIdleStamp_ = kIdleCycles;
+	UINT32 busy = (idle < elapsed) ? (elapsed - idle) : 0U;
+	UINT32 load = busy / (elapsed / 1000U);
+	if (load > 1000U)
+	{
+		load = 1000U;
+	}
+	loadSamples_[loadIdx_] = (UINT16) load;
+	loadIdx_ = (loadIdx_ + 1U) % K_DEF_CPULOAD_WIN_LONG;
+	loadCnt_ += 1U;
+	if (load > loadPeak_)
+	{
+		loadPeak_ = (UINT16) load;
+	}
+}
+
+/* mean of the last nWin samples taken */
+static UINT16 kCpuLoadMean_(UINT32 nWin)
+{
+	if (nWin > loadCnt_)
+	{
+		nWin = loadCnt_;
+	}
+	if (nWin == 0U)
+	{
+		return (0);
+	}
+	UINT32 sum = 0;
+	UINT32 idx = loadIdx_;
+	for (UINT32 i = 0; i < nWin; i++)
+	{
+		idx = (idx == 0U) ? (K_DEF_CPULOAD_WIN_LONG - 1U) : (idx - 1U);
+		sum += loadSamples_[idx];
+	}
+	return ((UINT16) (sum / nWin));
+}
+
+K_ERR kCpuLoadGet(K_CPULOAD *const loadPtr, BOOL const clearPeak)
+{
+	if (loadPtr == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_CR_AREA
+	K_ENTER_CR
+	loadPtr->loadShort = kCpuLoadMean_(K_DEF_CPULOAD_WIN_SHORT);
+	loadPtr->loadMid = kCpuLoadMean_(K_DEF_CPULOAD_WIN_MID);
+	loadPtr->loadLong = kCpuLoadMean_(K_DEF_CPULOAD_WIN_LONG);
+	loadPtr->peak = loadPeak_;
+	loadPtr->nSamples = loadCnt_;
+	if (clearPeak)
+	{
+		loadPeak_ = 0;
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+#endif
+
 BOOL kTickHandler(void)
 {
 	/* return is short-circuit to !runToCompl & */
@@ -542,6 +716,12 @@ BOOL kTickHandler(void)
 	BOOL timeOutTask = FALSE;
 	BOOL ret = FALSE;
 	runTime.globalTick += 1U;
+#if (K_DEF_CPULOAD==ON)
+	kCpuLoadSample_();
+#endif
+#if ((K_DEF_PCSAMPLE==ON) && (K_DEF_PCSAMPLE_TICK==ON))
+	kPcSampleISR();
+#endif
 	if (runPtr->busyWaitTime > 0)
 	{
 		runPtr->busyWaitTime -= 1U;
@@ -622,10 +802,277 @@ static inline PRIO kCalcNextTaskPrio_()
 	/* return __builtin_ctz(readyQRightMask); */
 }
 
+/* TRUE if there is a READY task with higher priority than tcbPtr */
+BOOL kSchNeedReschedule(K_TCB *tcbPtr)
+{
+	return ((kCalcNextTaskPrio_() < tcbPtr->priority) ? TRUE : FALSE);
+}
+
+/* changes the effective priority of a task; a READY task changes queue */
+VOID kSchSetPrio(K_TCB *tcbPtr, PRIO prio)
+{
+	K_CR_AREA
+	K_ENTER_CR
+	if ((tcbPtr->status == READY) && (tcbPtr->priority != prio))
+	{
+		PRIO oldPrio = tcbPtr->priority;
+		kTCBQRem(&readyQueue[oldPrio], &tcbPtr);
+		if (readyQueue[oldPrio].size == 0)
+			readyQBitMask &= ~(1U << oldPrio);
+		tcbPtr->priority = prio;
+		kTCBQEnq(&readyQueue[prio], tcbPtr);
+	}
+	else
+	{
+		tcbPtr->priority = prio;
+	}
+	K_EXIT_CR
+}
+
+#if (K_DEF_STACKMON==ON)
+/* paint above the sentinel, scanned upwards to the first word written;
+ * usage only grows, so a stack is never re-read past its last mark */
+static PID stackScanPid_;
+static UINT32 stackScanIdx_ = 1;
+
+static inline VOID kStackMark_(K_TCB *const tcbPtr, UINT32 const idx)
+{
+	UINT32 used = tcbPtr->stackSize - idx;
+	if (used > tcbPtr->stackMaxUsed)
+	{
+		tcbPtr->stackMaxUsed = used;
+	}
+}
+
+/* called by the idle task: at most K_DEF_STACKMON_SCAN reads */
+VOID kStackScanStep(VOID)
+{
+	K_TCB *tcbPtr = &tcbs[stackScanPid_];
+	if (tcbPtr->stackAddrPtr == NULL)
+	{
+		/* not created */
+		stackScanPid_ = (stackScanPid_ + 1) % NTHREADS;
+		return;
+	}
+	UINT32 limit = tcbPtr->stackSize - tcbPtr->stackMaxUsed;
+	for (UINT32 n = 0; n < K_DEF_STACKMON_SCAN; n++)
+	{
+		if ((stackScanIdx_ >= limit)
+				|| ((UINT32) tcbPtr->stackAddrPtr[stackScanIdx_]
+						!= K_STACK_PAINT))
+		{
+			kStackMark_(tcbPtr, stackScanIdx_);
+			stackScanIdx_ = 1;
+			stackScanPid_ = (stackScanPid_ + 1) % NTHREADS;
+			return;
+		}
+		stackScanIdx_++;
+	}
+}
+
+K_ERR kStackGetUsage(TID const taskID, UINT32 *const usedPtr,
+		UINT32 *const sizePtr)
+{
+	if (usedPtr == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	PID pid = kGetTaskPID(taskID);
+	if ((pid >= NTHREADS) || (tcbs[pid].stackAddrPtr == NULL))
+	{
+		return (K_ERR_INVALID_TID);
+	}
+	/* full scan, not to wait for the idle task */
+	K_TCB *tcbPtr = &tcbs[pid];
+	UINT32 idx = 1;
+	while ((idx < tcbPtr->stackSize)
+			&& ((UINT32) tcbPtr->stackAddrPtr[idx] == K_STACK_PAINT))
+	{
+		idx++;
+	}
+	K_CR_AREA
+	K_ENTER_CR
+	kStackMark_(tcbPtr, idx);
+	K_EXIT_CR
+	*usedPtr = tcbPtr->stackMaxUsed;
+	if (sizePtr != NULL)
+	{
+		*sizePtr = tcbPtr->stackSize;
+	}
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_LATENCY==ON)
+static inline VOID kLatencyRecord_(K_LATENCY *const latPtr, UINT32 const cycles)
+{
+	UINT32 bucket = (cycles > 1U) ? (31U - __builtin_clz(cycles)) : 0U;
+	if (bucket >= K_LATENCY_NBUCKETS)
+	{
+		bucket = K_LATENCY_NBUCKETS - 1U;
+	}
+	latPtr->hist[bucket] += 1U;
+	if ((latPtr->count == 0U) || (cycles < latPtr->min))
+	{
+		latPtr->min = cycles;
+	}
+	if (cycles > latPtr->max)
+	{
+		latPtr->max = cycles;
+	}
+	latPtr->sum += cycles;
+	latPtr->count += 1U;
+}
+
+K_ERR kLatencyGet(TID const taskID, K_LATENCY *const latPtr, BOOL const clear)
+{
+	if (latPtr == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	PID pid = kGetTaskPID(taskID);
+	if (pid >= NTHREADS)
+	{
+		return (K_ERR_INVALID_TID);
+	}
+	K_CR_AREA
+	K_ENTER_CR
+	*latPtr = tcbs[pid].latency;
+	if (clear)
+	{
+		UINT32 *wordPtr = (UINT32*) &tcbs[pid].latency;
+		for (SIZE i = 0; i < sizeof(K_LATENCY) / sizeof(UINT32); i++)
+		{
+			wordPtr[i] = 0;
+		}
+	}
+	K_EXIT_CR
+	latPtr->mean = (latPtr->count > 0U) ?
+			(UINT32) (latPtr->sum / latPtr->count) : 0U;
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_CONTENTION==ON)
+VOID kContentionReset(K_CONTENTION *const statsPtr)
+{
+	statsPtr->nBlocked = 0;
+	statsPtr->nTimeouts = 0;
+	statsPtr->maxCycles = 0;
+	statsPtr->totalCycles = 0;
+	statsPtr->maxHolder = 0xFF;
+}
+
+/* called within a critical region, before the running task is switched out */
+VOID kContentionBegin(ADDR const kobj, K_CONTENTION *const statsPtr,
+		K_TCB *const holderPtr, UINT32 *const holderCyclesPtr)
+{
+	runPtr->blockStamp = K_CYCLE_CNT;
+	runPtr->blockObj = kobj;
+	runPtr->blockStatsPtr = statsPtr;
+	runPtr->blockHolder = (holderPtr != NULL) ? holderPtr->pid : 0xFF;
+	runPtr->blockHolderPtr = holderCyclesPtr;
+}
+
+static VOID kContentionEnd_(K_TCB *const tcbPtr)
+{
+	UINT32 cycles = K_CYCLE_CNT - tcbPtr->blockStamp;
+	K_CONTENTION *statsPtr = tcbPtr->blockStatsPtr;
+	tcbPtr->blockStatsPtr = NULL;
+
+	statsPtr->nBlocked += 1U;
+	statsPtr->totalCycles += cycles;
+	if (tcbPtr->timeOut)
+	{
+		statsPtr->nTimeouts += 1U;
+	}
+	if (cycles > statsPtr->maxCycles)
+	{
+		statsPtr->maxCycles = cycles;
+		statsPtr->maxHolder = tcbPtr->blockHolder;
+	}
+	if ((tcbPtr->blockHolderPtr != NULL) && (tcbPtr->blockHolder < NTHREADS))
+	{
+		tcbPtr->blockHolderPtr[tcbPtr->blockHolder] += cycles;
+	}
+	/* per-task breakdown: the object slot, or the first free one */
+	K_CONTENTION_SLOT *slotPtr = NULL;
+	for (SIZE i = 0; i < K_DEF_CONTENTION_SLOTS; i++)
+	{
+		if (tcbPtr->blockedOn[i].kobj == tcbPtr->blockObj)
+		{
+			slotPtr = &tcbPtr->blockedOn[i];
+			break;
+		}
+		if ((slotPtr == NULL) && (tcbPtr->blockedOn[i].kobj == NULL))
+		{
+			slotPtr = &tcbPtr->blockedOn[i];
+		}
+	}
+	if (slotPtr == NULL)
+	{
+		tcbPtr->blockedOther += cycles;
+		return;
+	}
+	slotPtr->kobj = tcbPtr->blockObj;
+	slotPtr->nBlocked += 1U;
+	slotPtr->cycles += cycles;
+}
+
+K_ERR kTaskGetContention(TID const taskID, K_CONTENTION_SLOT *const slotsPtr,
+		UINT64 *const otherPtr, BOOL const clear)
+{
+	if (slotsPtr == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	PID pid = kGetTaskPID(taskID);
+	if (pid >= NTHREADS)
+	{
+		return (K_ERR_INVALID_TID);
+	}
+	K_CR_AREA
+	K_ENTER_CR
+	for (SIZE i = 0; i < K_DEF_CONTENTION_SLOTS; i++)
+	{
+		slotsPtr[i] = tcbs[pid].blockedOn[i];
+		if (clear)
+		{
+			tcbs[pid].blockedOn[i].kobj = NULL;
+			tcbs[pid].blockedOn[i].nBlocked = 0;
+			tcbs[pid].blockedOn[i].cycles = 0;
+		}
+	}
+	if (otherPtr != NULL)
+	{
+		*otherPtr = tcbs[pid].blockedOther;
+	}
+	if (clear)
+	{
+		tcbs[pid].blockedOther = 0;
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+#endif
+
 VOID kSchSwtch(VOID)
 {
 	K_TCB *nextRunPtr = NULL;
 	K_TCB *prevRunPtr = runPtr;
+#if (K_DEF_STACKMON==ON)
+	/* the task switched out overflowed its stack */
+	if (((UINT32) prevRunPtr->stackAddrPtr[0] != K_STACK_SENTINEL)
+			|| (prevRunPtr->sp < prevRunPtr->stackAddrPtr))
+	{
+		kErrHandler(FAULT_STACK_OVERFLOW);
+	}
+#endif
+#if (K_DEF_STATS==ON)
+	UINT32 switchStamp = K_CYCLE_CNT;
+	prevRunPtr->runCycles += switchStamp - kStatsSwitchStamp;
+	kStatsSwitchStamp = switchStamp;
+#endif
 	if (runPtr->status == RUNNING)
 	{
 		kReadyRunningTask_();
@@ -637,10 +1084,25 @@ VOID kSchSwtch(VOID)
 		kErrHandler(FAULT_NULL_OBJ);
 	}
 	runPtr = nextRunPtr;
+#if (K_DEF_LATENCY==ON)
+	if (runPtr->wakeArmed)
+	{
+		runPtr->wakeArmed = FALSE;
+		kLatencyRecord_(&runPtr->latency, K_CYCLE_CNT - runPtr->wakeStamp);
+	}
+#endif
+#if (K_DEF_CONTENTION==ON)
+	if (runPtr->blockStatsPtr != NULL)
+	{
+		kContentionEnd_(runPtr);
+	}
+#endif
 	if (nextRunPtr->pid != prevRunPtr->pid)
 	{
 		runPtr->nPreempted += 1U;
 		prevRunPtr->preemptedBy = runPtr->pid;
+		K_TRACE(K_TRACE_SWITCH, runPtr->pid,
+				prevRunPtr->pid | (prevRunPtr->status << 8), NULL)
 	}
 	if (runPtr->yield)
 	{
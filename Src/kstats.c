@@ -0,0 +1,361 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  Module           : Kernel Statistics
+ *  Depends on       : Scheduler, Timers
+ *  Provides to      : Application
+ *  Public API       : Yes
+ *
+ *  In this unit:
+ *  				 Statistics block
+ *  				 Monitor task
+ *
+ *****************************************************************************/
+
+/*******************************************************************************
+ * kStats gathers what the kernel already counts (run and preemption counts,
+ * lost signals, stack marks) with the CPU time of every task over the last
+ * period and the fill of the queues and pools registered with
+ * kStatsRegister. kStatsUpdate refreshes it; kStatsTask, created by the
+ * application at a low priority, does it every K_DEF_STATS_PERIOD ticks and
+ * prints the tasks sorted by CPU time.
+ *
+ * The block keeps its layout for a given version, so a debugger or a probe
+ * can read it while the core runs:
+ *
+ *   dump binary memory stats.bin &kStats (&kStats + 1)
+ *
+ * seq is odd while an update is in progress; a read is consistent if seq
+ * was even and did not change across it.
+ *
+ * With K_DEF_LOG in text mode the monitor does not block on the UART: each
+ * line is kept in a buffer of one period and queued on the kLog ring as a
+ * "%s" record. A period is skipped if the log task has not output the
+ * previous one.
+ *
+ * Task CPU time is taken from the cycle counter on every context switch;
+ * interrupts are charged to the task they preempted, and the idle task
+ * time is the load complement. A period must not exceed a cycle counter
+ * wrap (2^32 cycles).
+ ******************************************************************************/
+
+#define K_CODE
+#include <stdio.h>
+#include "kconfig.h"
+#include "kobjs.h"
+#include "kinternals.h"
+#include "ksch.h"
+#include "ktimer.h"
+#include "kutils.h"
+#include "kstats.h"
+#include "klog.h"
+
+#if (K_DEF_STATS==ON)
+
+#define K_STATS_MAGIC (0x4B535441) /* "KSTA" */
+#define K_STATS_LINE  (96)
+
+K_STATS kStats =
+{ .magic = K_STATS_MAGIC, .version = K_STATS_VERSION, .size = sizeof(K_STATS),
+		.nTasks = NTHREADS };
+
+UINT32 kStatsSwitchStamp;
+static UINT32 statsStamp_;
+static UINT32 statsLastRun_[NTHREADS];
+
+static VOID kStatsUart_(BYTE const *const bufPtr, SIZE const size)
+{
+	_write(1, (char*) bufPtr, (int) size);
+}
+
+#if ((K_DEF_LOG==ON) && (K_DEF_LOG_BINARY==OFF))
+
+#define K_STATS_NLINES (NTHREADS + K_DEF_STATS_NOBJS + 2) /* 2 headers */
+
+static CHAR statsLines_[K_STATS_NLINES][K_STATS_LINE];
+static SIZE statsNLines_;
+static UINT32 statsLogHead_;
+
+/* lines stay in place until the log task has output them */
+static VOID kStatsLog_(BYTE const *const bufPtr, SIZE const size)
+{
+	if (statsNLines_ >= K_STATS_NLINES)
+	{
+		return;
+	}
+	/* size < K_STATS_LINE (kStatsEmit_) */
+	CHAR *linePtr = statsLines_[statsNLines_++];
+	for (SIZE i = 0; i < size; i++)
+	{
+		linePtr[i] = (CHAR) bufPtr[i];
+	}
+	linePtr[size] = '\0';
+	kLogWrite("%s", 1, (UINT32) linePtr, 0, 0, 0);
+	statsLogHead_ = kLogBuf.head;
+}
+
+/* FALSE until the log task has output every line of the previous period.
+ * tail is not enough: a record leaves the ring before it is formatted. */
+static BOOL kStatsLogReady_(VOID)
+{
+	if ((INT32) (kLogBuf.done - statsLogHead_) < 0)
+	{
+		return (FALSE);
+	}
+	statsNLines_ = 0;
+	return (TRUE);
+}
+
+#define K_STATS_DEFAULT_OUTPUT kStatsLog_
+
+#else
+
+#define K_STATS_DEFAULT_OUTPUT kStatsUart_
+
+#endif
+
+static K_STATS_OUTPUT statsOutputFn_ = K_STATS_DEFAULT_OUTPUT;
+
+static VOID kStatsEmit_(CHAR const *const line, int len)
+{
+	if (len < 0)
+	{
+		return;
+	}
+	if (len >= K_STATS_LINE)
+	{
+		len = K_STATS_LINE - 1;
+	}
+	statsOutputFn_((BYTE const*) line, (SIZE) len);
+}
+
+K_ERR kStatsRegister(ADDR const kobj, K_STATS_OBJ const type,
+		STRING const name)
+{
+	K_CR_AREA
+	if (kobj == NULL)
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	if (kStats.nObjs >= K_DEF_STATS_NOBJS)
+	{
+		K_EXIT_CR
+		return (K_ERROR);
+	}
+	K_STATS_OBJ_ENTRY *entryPtr = &kStats.objs[kStats.nObjs];
+	entryPtr->kobj = (UINT32) kobj;
+	entryPtr->name = (UINT32) name;
+	entryPtr->type = (UINT32) type;
+	kStats.nObjs += 1U;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+static inline UINT16 kStatsPermille_(UINT32 const part, UINT32 const whole)
+{
+	UINT32 unit = whole / 1000U;
+	if (unit == 0U)
+	{
+		return (0);
+	}
+	UINT32 val = part / unit;
+	return ((UINT16) ((val > 1000U) ? 1000U : val));
+}
+
+static VOID kStatsObjFill_(K_STATS_OBJ_ENTRY *const entryPtr)
+{
+	switch ((K_STATS_OBJ) entryPtr->type)
+	{
+#if (K_DEF_MESGQ==ON)
+	case K_STATS_MESGQ:
+	{
+		K_MESGQ *qPtr = (K_MESGQ*) entryPtr->kobj;
+		entryPtr->used = qPtr->mesgCnt;
+		entryPtr->capacity = qPtr->maxMesg;
+#if (K_DEF_MESGQ_OVERWRITE==ON)
+		entryPtr->events = qPtr->dropCnt;
+#endif
+		break;
+	}
+#endif
+#if (K_DEF_MBOX==ON)
+	case K_STATS_MBOX:
+	{
+		K_MBOX *mboxPtr = (K_MBOX*) entryPtr->kobj;
+#if (K_DEF_MBOX_CAPACITY==MULTI)
+		entryPtr->used = mboxPtr->tailIdx - mboxPtr->headIdx;
+		entryPtr->capacity = mboxPtr->mask + 1U;
+#else
+		entryPtr->used = (mboxPtr->mailPtr != NULL) ? 1U : 0U;
+		entryPtr->capacity = 1U;
+#endif
+		break;
+	}
+#endif
+	case K_STATS_MEM:
+	{
+		K_MEM *memPtr = (K_MEM*) entryPtr->kobj;
+		entryPtr->used = memPtr->nMaxBlocks - memPtr->nFreeBlocks;
+		entryPtr->capacity = memPtr->nMaxBlocks;
+		break;
+	}
+#if (K_DEF_PDQ==ON)
+	case K_STATS_PDQ:
+	{
+		K_PDQ *pdqPtr = (K_PDQ*) entryPtr->kobj;
+		entryPtr->used = pdqPtr->memCtrlPtr->nMaxBlocks
+				- pdqPtr->memCtrlPtr->nFreeBlocks;
+		entryPtr->capacity = pdqPtr->memCtrlPtr->nMaxBlocks;
+		entryPtr->events = pdqPtr->failReserve;
+		break;
+	}
+#endif
+	default:
+		break;
+	}
+}
+
+VOID kStatsUpdate(VOID)
+{
+	K_CR_AREA
+	K_ENTER_CR
+	UINT32 now = K_CYCLE_CNT;
+	kStats.seq += 1U;
+	DMB
+	UINT32 period = now - statsStamp_;
+	statsStamp_ = now;
+	kStats.tick = runTime.globalTick;
+	kStats.cpuHz = SystemCoreClock;
+	kStats.periodCycles = period;
+	for (SIZE i = 0; i < NTHREADS; i++)
+	{
+		K_TCB *tcbPtr = &tcbs[i];
+		K_STATS_TASK *taskPtr = &kStats.tasks[i];
+		/* the running task slice is not closed yet */
+		UINT32 run = tcbPtr->runCycles;
+		if (tcbPtr == runPtr)
+		{
+			run += now - kStatsSwitchStamp;
+		}
+		taskPtr->runCycles = run - statsLastRun_[i];
+		statsLastRun_[i] = run;
+		taskPtr->cpu = kStatsPermille_(taskPtr->runCycles, period);
+		taskPtr->runCnt = tcbPtr->runCnt;
+		taskPtr->nPreempted = tcbPtr->nPreempted;
+		taskPtr->lostSignals = tcbPtr->lostSignals;
+		taskPtr->stackSize = tcbPtr->stackSize;
+#if (K_DEF_STACKMON==ON)
+		taskPtr->stackUsed = tcbPtr->stackMaxUsed;
+#endif
+		taskPtr->pid = tcbPtr->pid;
+		taskPtr->tid = tcbPtr->uPid;
+		taskPtr->status = (BYTE) tcbPtr->status;
+		taskPtr->priority = tcbPtr->priority;
+		taskPtr->realPrio = tcbPtr->realPrio;
+		taskPtr->preemptedBy = tcbPtr->preemptedBy;
+	}
+	PID idlePid = kGetTaskPID(IDLETASK_ID);
+	kStats.load = (idlePid < NTHREADS) ?
+			(1000U - kStats.tasks[idlePid].cpu) : 0U;
+	for (SIZE i = 0; i < kStats.nObjs; i++)
+	{
+		kStatsObjFill_(&kStats.objs[i]);
+	}
+	DMB
+	kStats.seq += 1U;
+	K_EXIT_CR
+}
+
+static STRING const statsStatus_[] =
+{ "INVALID", "READY", "RUNNING", "PENDING", "SLEEPING", "BLOCKED",
+		"SUSPENDED", "SENDING", "RECEIVING" };
+
+static VOID kStatsPrint_(VOID)
+{
+	static K_STATS snap;
+	CHAR line[K_STATS_LINE];
+	PID order[NTHREADS];
+	int len;
+
+#if ((K_DEF_LOG==ON) && (K_DEF_LOG_BINARY==OFF))
+	if ((statsOutputFn_ == kStatsLog_) && (!kStatsLogReady_()))
+	{
+		return;
+	}
+#endif
+	K_CR_AREA
+	K_ENTER_CR
+	snap = kStats;
+	K_EXIT_CR
+
+	/* busiest first */
+	for (SIZE i = 0; i < NTHREADS; i++)
+	{
+		SIZE j = i;
+		while ((j > 0) && (snap.tasks[order[j - 1]].cpu < snap.tasks[i].cpu))
+		{
+			order[j] = order[j - 1];
+			j--;
+		}
+		order[j] = (PID) i;
+	}
+
+	len = snprintf(line, sizeof(line), "\n--- tick %lu  load %u.%u%% ---\n",
+			(unsigned long) snap.tick, (unsigned) (snap.load / 10U),
+			(unsigned) (snap.load % 10U));
+	kStatsEmit_(line, len);
+	len = snprintf(line, sizeof(line),
+			"PID TID PRIO STATE       CPU%%  STACK     RUNS PREEMPT LOST\n");
+	kStatsEmit_(line, len);
+	for (SIZE i = 0; i < NTHREADS; i++)
+	{
+		K_STATS_TASK const *taskPtr = &snap.tasks[order[i]];
+		STRING status = (taskPtr->status <= RECEIVING) ?
+				statsStatus_[taskPtr->status] : "?";
+		len = snprintf(line, sizeof(line),
+				"%3u %3u %2u/%-2u %-9s %3u.%u %3lu/%-4lu %6lu %7lu %4lu %s\n",
+				(unsigned) taskPtr->pid, (unsigned) taskPtr->tid,
+				(unsigned) taskPtr->priority, (unsigned) taskPtr->realPrio,
+				status, (unsigned) (taskPtr->cpu / 10U),
+				(unsigned) (taskPtr->cpu % 10U),
+				(unsigned long) taskPtr->stackUsed,
+				(unsigned long) taskPtr->stackSize,
+				(unsigned long) taskPtr->runCnt,
+				(unsigned long) taskPtr->nPreempted,
+				(unsigned long) taskPtr->lostSignals,
+				(tcbs[taskPtr->pid].taskName != NULL) ?
+						tcbs[taskPtr->pid].taskName : "");
+		kStatsEmit_(line, len);
+	}
+	for (SIZE i = 0; i < snap.nObjs; i++)
+	{
+		K_STATS_OBJ_ENTRY const *entryPtr = &snap.objs[i];
+		len = snprintf(line, sizeof(line), "%-16s %4lu/%-4lu events %lu\n",
+				(entryPtr->name != 0U) ? (STRING) entryPtr->name : "?",
+				(unsigned long) entryPtr->used,
+				(unsigned long) entryPtr->capacity,
+				(unsigned long) entryPtr->events);
+		kStatsEmit_(line, len);
+	}
+}
+
+VOID kStatsTask(VOID)
+{
+	for (;;)
+	{
+		kSleep(K_DEF_STATS_PERIOD);
+		kStatsUpdate();
+		kStatsPrint_();
+	}
+}
+
+VOID kStatsSetOutput(K_STATS_OUTPUT const outputFn)
+{
+	statsOutputFn_ = (outputFn != NULL) ? outputFn : K_STATS_DEFAULT_OUTPUT;
+}
+
+#endif /* K_DEF_STATS */
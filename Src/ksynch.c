@@ -28,6 +28,8 @@
 #include "ksch.h"
 #include "ktimer.h"
 #include "kinternals.h"
+#include "ktrace.h"
+#include "katomic.h"
 
 /*******************************************************************************
  * DIRECT TASK PENDING/SIGNAL
@@ -46,6 +48,7 @@ K_ERR kPend(VOID)
 	err = kTCBQEnq(&sleepingQueue, runPtr);
 
 	runPtr->status = PENDING;
+	K_TRACE_BLOCK(NULL)
 
 	K_PEND_CTXTSWTCH
 
@@ -129,6 +132,154 @@ K_ERR kSuspend(TID const taskID)
 
 }
 
+#if (K_DEF_TASK_NOTIFY==ON)
+/*******************************************************************************
+ * TASK NOTIFICATION
+ *******************************************************************************/
+
+static inline VOID kNotifyUpdate_(K_TCB *const tcbPtr, UINT32 const value,
+		K_NOTIFY_ACTION const action)
+{
+	switch (action)
+	{
+	case K_NOTIFY_SET_BITS:
+		tcbPtr->notifyVal |= value;
+		break;
+	case K_NOTIFY_INCREMENT:
+		tcbPtr->notifyVal += 1U;
+		break;
+	case K_NOTIFY_OVERWRITE:
+		tcbPtr->notifyVal = value;
+		break;
+	default:
+		break;
+	}
+	tcbPtr->notifyPend = TRUE;
+}
+
+/* takes a notified task off the sleeping queue; returns it or NULL */
+static inline K_TCB* kNotifyDeqWaiter_(K_TCB *tcbPtr)
+{
+	if ((tcbPtr->status != PENDING) || (tcbPtr->notifyWait == FALSE))
+	{
+		return (NULL);
+	}
+	assert(!kTCBQRem(&sleepingQueue, &tcbPtr));
+	tcbPtr->notifyWait = FALSE;
+	kTimeOutCancel(&tcbPtr->notifyTimeoutNode);
+	return (tcbPtr);
+}
+
+K_ERR kNotify(TID const taskID, UINT32 const value,
+		K_NOTIFY_ACTION const action)
+{
+	if (kIsISR())
+	{
+		kErrHandler(FAULT_ISR_INVALID_PRIMITVE);
+	}
+	K_CR_AREA
+	K_ENTER_CR
+	PID pid = kGetTaskPID(taskID);
+	if (pid >= NTHREADS)
+	{
+		K_EXIT_CR
+		return (K_ERR_INVALID_TID);
+	}
+	kNotifyUpdate_(&tcbs[pid], value, action);
+	K_TCB *tcbPtr = kNotifyDeqWaiter_(&tcbs[pid]);
+	if (tcbPtr != NULL)
+	{
+		assert(!kReadyCtxtSwtch(tcbPtr));
+	}
+	tcbs[pid].signalledBy = runPtr->uPid;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kNotifyFromISR(TID const taskID, UINT32 const value,
+		K_NOTIFY_ACTION const action)
+{
+	K_CR_AREA
+	K_ENTER_CR
+	PID pid = kGetTaskPID(taskID);
+	if (pid >= NTHREADS)
+	{
+		K_EXIT_CR
+		return (K_ERR_INVALID_TID);
+	}
+	kNotifyUpdate_(&tcbs[pid], value, action);
+	K_TCB *tcbPtr = kNotifyDeqWaiter_(&tcbs[pid]);
+	if (tcbPtr != NULL)
+	{
+		/* the interrupted task is put back on READY by the switch itself */
+		assert(!kTCBQEnq(&readyQueue[tcbPtr->priority], tcbPtr));
+		tcbPtr->status = READY;
+		K_TRACE(K_TRACE_READY, tcbPtr->pid, 0, NULL)
+		K_WAKE_STAMP(tcbPtr)
+		if (tcbPtr->priority < runPtr->priority)
+		{
+			K_PEND_CTXTSWTCH
+		}
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+K_ERR kNotifyWait(UINT32 *const valuePtr, BOOL const clear,
+		TICK const timeout)
+{
+	if (kIsISR())
+	{
+		kErrHandler(FAULT_ISR_INVALID_PRIMITVE);
+	}
+	K_CR_AREA
+	K_ENTER_CR
+	if (runPtr->notifyPend == FALSE)
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_EXIT_CR
+			return (K_ERR_NOTIFY_EMPTY);
+		}
+		if (timeout < K_WAIT_FOREVER)
+		{
+			kTimeOut(&runPtr->notifyTimeoutNode, timeout);
+		}
+		do
+		{
+			kTCBQEnq(&sleepingQueue, runPtr);
+			runPtr->status = PENDING;
+			K_TRACE_BLOCK(NULL)
+			runPtr->notifyWait = TRUE;
+			K_PEND_CTXTSWTCH
+			K_EXIT_CR
+			K_ENTER_CR
+			if (runPtr->timeOut)
+			{
+				runPtr->timeOut = FALSE;
+				K_EXIT_CR
+				return (K_ERR_TIMEOUT);
+			}
+			/* a plain kSignal also resumes a pending task */
+		} while (runPtr->notifyPend == FALSE);
+		runPtr->notifyWait = FALSE;
+		kTimeOutCancel(&runPtr->notifyTimeoutNode);
+	}
+	if (valuePtr != NULL)
+	{
+		*valuePtr = runPtr->notifyVal;
+	}
+	if (clear == TRUE)
+	{
+		runPtr->notifyVal = 0;
+	}
+	runPtr->notifyPend = FALSE;
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+
+#endif /* task notification */
+
 #if (K_DEF_SLEEPWAKE==ON)
 /******************************************************************************
  * SLEEP/WAKE ON EVENTS
@@ -174,13 +325,17 @@ K_ERR kEventSleep(K_EVENT *kobj, TICK timeout)
 
 	kTCBQEnqByPrio(&kobj->waitingQueue, runPtr);
 	runPtr->status = SLEEPING;
+	K_TRACE_BLOCK(kobj)
 	runPtr->pendingEv = kobj;
 	if ((timeout > 0) && (timeout < K_WAIT_FOREVER))
 	{
 		kTimeOut(&kobj->timeoutNode, timeout);
 	}
 	K_PEND_CTXTSWTCH
+	K_EXIT_CR
+	K_ENTER_CR
 	/* resuming here, if time is out, return error */
+	runPtr->pendingEv = NULL;
 	if (runPtr->timeOut)
 	{
 		runPtr->timeOut = FALSE;
@@ -207,17 +362,8 @@ VOID kEventWake(K_EVENT *kobj)
 	{
 		kErrHandler(FAULT_OBJ_NOT_INIT);
 	}
-	SIZE sleepThreads = kobj->waitingQueue.size;
-	if (sleepThreads > 0)
-	{
-		for (SIZE i = 0; i < sleepThreads; ++i)
-		{
-			K_TCB *nextTCBPtr;
-			kTCBQDeq(&kobj->waitingQueue, &nextTCBPtr);
-			assert(!kReadyCtxtSwtch(nextTCBPtr));
-			nextTCBPtr->pendingEv = NULL;
-		}
-	}
+	/* sleepers clear their pendingEv when resuming */
+	kReadyAllCtxtSwtch(&kobj->waitingQueue);
 	K_EXIT_CR
 	return;
 }
@@ -241,7 +387,6 @@ VOID kEventSignal(K_EVENT *kobj)
 	K_TCB *nextTCBPtr;
 	kTCBQDeq(&kobj->waitingQueue, &nextTCBPtr);
 	assert(!kReadyCtxtSwtch(nextTCBPtr));
-	nextTCBPtr->pendingEv = NULL;
 
 	K_EXIT_CR
 	return;
@@ -262,6 +407,19 @@ UINT32 kEventQuery(K_EVENT *const kobj)
 /******************************************************************************
  * SEMAPHORES
  ******************************************************************************/
+#if (K_DEF_SEMA_PRIOINV==ON)
+/* drop the priority inherited through a semaphore, but not below the
+ * ceiling of a mutex the task still holds */
+static inline VOID kSemaPrioRestore_(VOID)
+{
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	runPtr->priority = runPtr->ceilPrio;
+#else
+	runPtr->priority = runPtr->realPrio;
+#endif
+}
+#endif
+
 K_ERR kSemaInit(K_SEMA *const kobj, INT32 const value)
 {
 	K_CR_AREA
@@ -286,6 +444,9 @@ K_ERR kSemaInit(K_SEMA *const kobj, INT32 const value)
 
 	kobj->ownerPtr = NULL;
 
+#endif
+#if (K_DEF_CONTENTION==ON)
+	kContentionReset(&kobj->contention);
 #endif
 	kobj->timeoutNode.nextPtr = NULL;
 	kobj->timeoutNode.timeout = 0;
@@ -295,6 +456,52 @@ K_ERR kSemaInit(K_SEMA *const kobj, INT32 const value)
 	return (K_SUCCESS);
 }
 
+#if (K_DEF_SYNCH_FASTPATH==ON)
+/* With K_DEF_SEMA_PRIOINV a wait has to take the unit and record the owner
+ * at once: a task preempting in between would block and boost a stale
+ * owner. Such waits stay in the critical region. */
+#if (K_DEF_SEMA_PRIOINV==OFF)
+/* uncontended wait: take a unit if the counter is positive */
+static inline BOOL kSemaWaitFast_(K_SEMA *const kobj)
+{
+	UINT32 volatile *valPtr = (UINT32 volatile*) &kobj->value;
+	INT32 val;
+	do
+	{
+		val = (INT32) kLdrEx(valPtr);
+		if (val <= 0)
+		{
+			kClrEx();
+			return (FALSE);
+		}
+	} while (!kStrEx(valPtr, (UINT32) val, (UINT32) (val - 1)));
+	DMB
+	return (TRUE);
+}
+#endif
+
+/* uncontended signal: give a unit back if there are no waiters */
+static inline BOOL kSemaSignalFast_(K_SEMA *const kobj)
+{
+	UINT32 volatile *valPtr = (UINT32 volatile*) &kobj->value;
+	INT32 val;
+	do
+	{
+		val = (INT32) kLdrEx(valPtr);
+		if (val < 0)
+		{
+			kClrEx();
+			return (FALSE);
+		}
+	} while (!kStrEx(valPtr, (UINT32) val, (UINT32) (val + 1)));
+	DMB
+#if (K_DEF_SEMA_PRIOINV==ON)
+	kSemaPrioRestore_();
+#endif
+	return (TRUE);
+}
+#endif
+
 K_ERR kSemaWait(K_SEMA *const kobj, TICK const timeout)
 {
 	if (kIsISR())
@@ -310,6 +517,12 @@ K_ERR kSemaWait(K_SEMA *const kobj, TICK const timeout)
 	{
 		kErrHandler(FAULT_NULL_OBJ);
 	}
+#if ((K_DEF_SYNCH_FASTPATH==ON) && (K_DEF_SEMA_PRIOINV==OFF))
+	if (kSemaWaitFast_(kobj))
+	{
+		return (K_SUCCESS);
+	}
+#endif
 
 	K_CR_AREA
 	K_ENTER_CR
@@ -324,6 +537,12 @@ K_ERR kSemaWait(K_SEMA *const kobj, TICK const timeout)
 		kTCBQEnqByPrio(&kobj->waitingQueue, runPtr);
 #endif
 		runPtr->status = BLOCKED;
+		K_TRACE_BLOCK(kobj)
+#if (K_DEF_SEMA_PRIOINV==ON)
+		K_CONTENTION_BLOCK(kobj, &kobj->contention, kobj->ownerPtr, NULL)
+#else
+		K_CONTENTION_BLOCK(kobj, &kobj->contention, NULL, NULL)
+#endif
 		runPtr->pendingSema = kobj;
 		DMB
 
@@ -370,6 +589,12 @@ K_ERR kSemaWait(K_SEMA *const kobj, TICK const timeout)
 
 VOID kSemaSignal(K_SEMA *const kobj)
 {
+#if (K_DEF_SYNCH_FASTPATH==ON)
+	if ((kobj != NULL) && (kobj->init == TRUE) && kSemaSignalFast_(kobj))
+	{
+		return;
+	}
+#endif
 	K_CR_AREA
 	K_ENTER_CR
 	if (kobj == NULL)
@@ -396,7 +621,7 @@ VOID kSemaSignal(K_SEMA *const kobj)
 	}
 #if (K_DEF_SEMA_PRIOINV==ON)
 
-	runPtr->priority = runPtr->realPrio;
+	kSemaPrioRestore_();
 #endif
 
 	K_EXIT_CR
@@ -417,6 +642,26 @@ INT32 kSemaQuery(K_SEMA *const kobj)
 	return (kobj->value);
 }
 
+#if (K_DEF_CONTENTION==ON)
+K_ERR kSemaGetContention(K_SEMA *const kobj, K_CONTENTION *const statsPtr,
+		BOOL const clear)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (statsPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	*statsPtr = kobj->contention;
+	if (clear)
+	{
+		kContentionReset(&kobj->contention);
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+#endif
+
 #endif /*sema*/
 
 #if (K_DEF_MUTEX == ON)
@@ -431,22 +676,214 @@ K_ERR kMutexInit(K_MUTEX *const kobj)
 		kErrHandler(FAULT_NULL_OBJ);
 		return (K_ERROR);
 	}
-	kobj->lock = FALSE
-	;
+	kobj->ownerPtr = NULL;
 	if (kTCBQInit(&(kobj->waitingQueue), "mutexQ") != K_SUCCESS)
 	{
 		kErrHandler(FAULT_LIST);
 		return (K_ERROR);
 	}
 	kobj->init = TRUE;
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	kobj->ceiling = K_MUTEX_NO_CEIL;
+	kobj->nextHeldPtr = NULL;
+#endif
 	kobj->timeoutNode.nextPtr = NULL;
 	kobj->timeoutNode.timeout = 0;
 	kobj->timeoutNode.kobj = kobj;
 	kobj->timeoutNode.objectType = MUTEX;
+#if (K_DEF_CONTENTION==ON)
+	kContentionReset(&kobj->contention);
+	for (SIZE i = 0; i < NTHREADS; i++)
+	{
+		kobj->holderCycles[i] = 0;
+	}
+#endif
 	return (K_SUCCESS);
 }
+
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+K_ERR kMutexInitCeil(K_MUTEX *const kobj, PRIO const ceiling)
+{
+	if (ceiling > K_DEF_MIN_PRIO)
+	{
+		return (K_ERR_INVALID_PRIO);
+	}
+	K_ERR err = kMutexInit(kobj);
+	if (err == K_SUCCESS)
+	{
+		kobj->ceiling = ceiling;
+	}
+	return (err);
+}
+
+/* the owner keeps a list of the ceiling mutexes it holds; its ceilPrio is
+ * the highest of their ceilings, so they can be unlocked in any order */
+static inline VOID kMutexCeilPush_(K_MUTEX *const kobj, K_TCB *const tcbPtr)
+{
+	kobj->nextHeldPtr = tcbPtr->ceilHeldPtr;
+	tcbPtr->ceilHeldPtr = kobj;
+	if (kobj->ceiling < tcbPtr->ceilPrio)
+	{
+		tcbPtr->ceilPrio = kobj->ceiling;
+	}
+}
+
+/* no effect if kobj is not on the list */
+static VOID kMutexCeilPop_(K_MUTEX *const kobj, K_TCB *const tcbPtr)
+{
+	K_MUTEX **linkPtr = &tcbPtr->ceilHeldPtr;
+	PRIO prio = tcbPtr->realPrio;
+	while (*linkPtr != NULL)
+	{
+		if (*linkPtr == kobj)
+		{
+			*linkPtr = kobj->nextHeldPtr;
+			kobj->nextHeldPtr = NULL;
+			continue;
+		}
+		if ((*linkPtr)->ceiling < prio)
+		{
+			prio = (*linkPtr)->ceiling;
+		}
+		linkPtr = &(*linkPtr)->nextHeldPtr;
+	}
+	tcbPtr->ceilPrio = prio;
+}
+
+/* new owner runs at the ceiling */
+static inline VOID kMutexCeilRaise_(K_MUTEX *const kobj, K_TCB *const tcbPtr)
+{
+	kMutexCeilPush_(kobj, tcbPtr);
+	if (kobj->ceiling < tcbPtr->priority)
+	{
+		tcbPtr->priority = kobj->ceiling;
+	}
+}
+#endif
+
+/* drop the owner priority on unlock: inherited boosts are undone, but not
+ * below the ceiling of the ceiling mutexes it still holds */
+static inline VOID kMutexOwnerPrioRestore_(K_MUTEX *const kobj)
+{
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	if (kobj->ceiling != K_MUTEX_NO_CEIL)
+	{
+		kMutexCeilPop_(kobj, kobj->ownerPtr);
+	}
+	kobj->ownerPtr->priority = kobj->ownerPtr->ceilPrio;
+#else
+	kobj->ownerPtr->priority = kobj->ownerPtr->realPrio;
+#endif
+}
+
+#if (K_DEF_SYNCH_FASTPATH==ON)
+/* uncontended lock: owner word from NULL to runPtr */
+static inline BOOL kMutexLockFast_(K_MUTEX *const kobj)
+{
+	if ((kobj == NULL) || (kobj->init == FALSE) || kIsISR())
+	{
+		return (FALSE);
+	}
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	PRIO prio = runPtr->priority;
+	if (kobj->ceiling != K_MUTEX_NO_CEIL)
+	{
+		if (runPtr->realPrio < kobj->ceiling)
+		{
+			return (FALSE);
+		}
+		/* raised before owning, so there is no window at base priority */
+		if (kobj->ceiling < prio)
+		{
+			runPtr->priority = kobj->ceiling;
+		}
+	}
+#endif
+	do
+	{
+		if (K_LDREX_PTR(&kobj->ownerPtr) != NULL)
+		{
+			kClrEx();
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+			runPtr->priority = prio;
+#endif
+			return (FALSE);
+		}
+	} while (!K_STREX_PTR(&kobj->ownerPtr, NULL, runPtr));
+	DMB
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	/* only the owner touches the held list */
+	if (kobj->ceiling != K_MUTEX_NO_CEIL)
+	{
+		kMutexCeilPush_(kobj, runPtr);
+	}
+#endif
+	return (TRUE);
+}
+
+/* uncontended unlock: owner word from runPtr to NULL, if nobody waits and
+ * no priority was inherited */
+static inline BOOL kMutexUnlockFast_(K_MUTEX *const kobj)
+{
+	if ((kobj == NULL) || (kobj->init == FALSE))
+	{
+		return (FALSE);
+	}
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	/* off the held list while still owned: once released, the next owner
+	 * links it on its own list. A fall back to the slow path finds it
+	 * already off. */
+	if ((kobj->ceiling != K_MUTEX_NO_CEIL) && (kobj->ownerPtr == runPtr))
+	{
+		kMutexCeilPop_(kobj, runPtr);
+	}
+#endif
+	do
+	{
+		if ((K_LDREX_PTR(&kobj->ownerPtr) != runPtr)
+				|| (kobj->waitingQueue.size != 0))
+		{
+			kClrEx();
+			return (FALSE);
+		}
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+		/* an inherited boost is undone by the slow path */
+		if ((kobj->ceiling == K_MUTEX_NO_CEIL)
+				&& (runPtr->priority != runPtr->ceilPrio))
+#else
+		if (runPtr->priority != runPtr->realPrio)
+#endif
+		{
+			kClrEx();
+			return (FALSE);
+		}
+	} while (!K_STREX_PTR(&kobj->ownerPtr, runPtr, NULL));
+	DMB
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	PRIO prio = runPtr->ceilPrio;
+#else
+	PRIO prio = runPtr->realPrio;
+#endif
+	if (runPtr->priority != prio)
+	{
+		runPtr->priority = prio;
+		if (kSchNeedReschedule(runPtr))
+		{
+			K_PEND_CTXTSWTCH
+		}
+	}
+	return (TRUE);
+}
+#endif
+
 K_ERR kMutexLock(K_MUTEX *const kobj, TICK timeout)
 {
+#if (K_DEF_SYNCH_FASTPATH==ON)
+	if (kMutexLockFast_(kobj))
+	{
+		return (K_SUCCESS);
+	}
+#endif
 	K_CR_AREA
 	K_ENTER_CR
 	if (kobj->init == FALSE)
@@ -461,11 +898,25 @@ K_ERR kMutexLock(K_MUTEX *const kobj, TICK timeout)
 	{
 		kErrHandler(FAULT_ISR_INVALID_PRIMITVE);
 	}
-	if (kobj->lock == FALSE)
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+	if ((kobj->ceiling != K_MUTEX_NO_CEIL) && (runPtr->realPrio < kobj->ceiling))
+	{
+		/* caller is not accounted for by the ceiling */
+		K_EXIT_CR
+		return (K_ERR_MUTEX_CEIL_VIOL);
+	}
+#endif
+	if (kobj->ownerPtr == NULL)
 	{
 		/* lock mutex and set the owner */
-		kobj->lock = TRUE;
 		kobj->ownerPtr = runPtr;
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+		/* ceiling mutex: no contention handling on an uncontended lock */
+		if (kobj->ceiling != K_MUTEX_NO_CEIL)
+		{
+			kMutexCeilRaise_(kobj, runPtr);
+		}
+#endif
 		K_EXIT_CR
 		return (K_SUCCESS);
 	}
@@ -476,7 +927,13 @@ K_ERR kMutexLock(K_MUTEX *const kobj, TICK timeout)
 			K_EXIT_CR
 			return (K_ERR_MUTEX_LOCKED);
 		}
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+		/* owner of a ceiling mutex already runs at the ceiling */
+		if ((kobj->ceiling == K_MUTEX_NO_CEIL)
+				&& (kobj->ownerPtr->priority > runPtr->priority))
+#else
 		if (kobj->ownerPtr->priority > runPtr->priority)
+#endif
 		{
 			/* mutex owner has lower priority than the tried-to-lock-task
 			 * thus, we boost owner priority, to avoid an intermediate
@@ -494,6 +951,9 @@ K_ERR kMutexLock(K_MUTEX *const kobj, TICK timeout)
 		if ((timeout > 0) && (timeout < 0xFFFFFFFF))
 			kTimeOut(&kobj->timeoutNode, timeout);
 		runPtr->status = BLOCKED;
+		K_TRACE_BLOCK(kobj)
+		K_CONTENTION_BLOCK(kobj, &kobj->contention, kobj->ownerPtr,
+				kobj->holderCycles)
 		runPtr->pendingMutx = (K_MUTEX*) kobj;
 		K_PEND_CTXTSWTCH
 		K_EXIT_CR
@@ -520,6 +980,12 @@ K_ERR kMutexLock(K_MUTEX *const kobj, TICK timeout)
 
 VOID kMutexUnlock(K_MUTEX *const kobj)
 {
+#if (K_DEF_SYNCH_FASTPATH==ON)
+	if (kMutexUnlockFast_(kobj))
+	{
+		return;
+	}
+#endif
 	K_CR_AREA
 	K_ENTER_CR
 	K_TCB *tcbPtr;
@@ -531,8 +997,9 @@ VOID kMutexUnlock(K_MUTEX *const kobj)
 	{
 		assert(0);
 	}
-	if ((kobj->lock == FALSE))
+	if (kobj->ownerPtr == NULL)
 	{
+		K_EXIT_CR
 		return;
 	}
 	if (kobj->ownerPtr != runPtr)
@@ -544,11 +1011,17 @@ VOID kMutexUnlock(K_MUTEX *const kobj)
 	/* runPtr is the owner and mutex was locked */
 	if (kobj->waitingQueue.size == 0)
 	{
-		kobj->lock = FALSE;
-		kobj->ownerPtr->priority = kobj->ownerPtr->realPrio;
+		kMutexOwnerPrioRestore_(kobj);
 		kobj->ownerPtr->pendingMutx = NULL;
 		tcbPtr = kobj->ownerPtr;
 		kobj->ownerPtr = NULL;
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+		/* dropping from the ceiling may leave a higher priority task READY */
+		if ((kobj->ceiling != K_MUTEX_NO_CEIL) && kSchNeedReschedule(runPtr))
+		{
+			K_PEND_CTXTSWTCH
+		}
+#endif
 	}
 	else
 	{
@@ -558,14 +1031,26 @@ VOID kMutexUnlock(K_MUTEX *const kobj)
 		if (IS_NULL_PTR(tcbPtr))
 			kErrHandler(FAULT_NULL_OBJ);
 		/* here only runptr can unlock a mutex*/
-		if (runPtr->priority < runPtr->realPrio)
+		kMutexOwnerPrioRestore_(kobj);
+		kobj->ownerPtr = tcbPtr;
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+		if (kobj->ceiling != K_MUTEX_NO_CEIL)
 		{
-			runPtr->priority = runPtr->realPrio;
+			/* raise the new owner before it is READY */
+			kMutexCeilRaise_(kobj, tcbPtr);
 		}
+#endif
 			if (!kReadyCtxtSwtch(tcbPtr))
 			{
-				kobj->ownerPtr = tcbPtr;
 				tcbPtr->pendingMutx = NULL;
+#if (K_DEF_MUTEX_PRIO_CEIL==ON)
+				if ((kobj->ceiling != K_MUTEX_NO_CEIL)
+						&& (runPtr->status == RUNNING)
+						&& kSchNeedReschedule(runPtr))
+				{
+					K_PEND_CTXTSWTCH
+				}
+#endif
 				K_EXIT_CR
 				return;
 			}
@@ -594,12 +1079,12 @@ K_ERR kMutexQuery(K_MUTEX *const kobj)
 		K_EXIT_CR
 		return (K_ERR_OBJ_NOT_INIT);
 	}
-	if (kobj->lock == TRUE)
+	if (kobj->ownerPtr != NULL)
 	{
 		K_EXIT_CR
 		return (K_QUERY_MUTEX_LOCKED);
 	}
-	if (kobj->lock == FALSE)
+	if (kobj->ownerPtr == NULL)
 	{
 		K_EXIT_CR
 		return (K_QUERY_MUTEX_UNLOCKED);
@@ -608,4 +1093,35 @@ K_ERR kMutexQuery(K_MUTEX *const kobj)
 	return (K_ERROR);
 }
 
+#if (K_DEF_CONTENTION==ON)
+K_ERR kMutexGetContention(K_MUTEX *const kobj, K_CONTENTION *const statsPtr,
+		UINT32 *const holderCyclesPtr, BOOL const clear)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (statsPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_ENTER_CR
+	*statsPtr = kobj->contention;
+	for (SIZE i = 0; i < NTHREADS; i++)
+	{
+		if (holderCyclesPtr != NULL)
+		{
+			holderCyclesPtr[i] = kobj->holderCycles[i];
+		}
+		if (clear)
+		{
+			kobj->holderCycles[i] = 0;
+		}
+	}
+	if (clear)
+	{
+		kContentionReset(&kobj->contention);
+	}
+	K_EXIT_CR
+	return (K_SUCCESS);
+}
+#endif
+
 #endif /* mutex */
@@ -21,6 +21,7 @@
 #include "kitc.h"
 #include "ktimer.h"
 #include "kinternals.h"
+#include "ksch.h"
 
 
 INT idleStack[IDLE_STACKSIZE];
@@ -33,9 +34,24 @@ void IdleTask(void) /*SAD: on a well designed system this fella runs for
 
 	while (1)
 	{
+#if (K_DEF_STACKMON==ON)
+		kStackScanStep();
+#endif
+#if (K_DEF_CPULOAD==ON)
+		/* the interrupt that ends the sleep is taken after the count,
+		 * so only the sleep itself is idle time */
+		__disable_irq();
+		UINT32 stamp = K_CYCLE_CNT;
 		__DSB();
 		__WFI();
+		kIdleCycles += K_CYCLE_CNT - stamp;
+		__enable_irq();
 		__ISB();
+#else
+		__DSB();
+		__WFI();
+		__ISB();
+#endif
 	}
 }
 
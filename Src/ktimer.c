@@ -27,6 +27,7 @@
 #include "kutils.h"
 #include "kinternals.h"
 #include "ktimer.h"
+#include "ktrace.h"
 
 K_MEM timerMem;
 K_TIMER *dTimReloadList = NULL; /* periodic timers */
@@ -164,6 +165,7 @@ BOOL kTimerHandler(void)
 		K_TIMER *expTimerPtr = dTimOneShotList;
 		/* ... as long there is that tick, tick...*/
 		expTimerPtr = dTimOneShotList;
+		K_TRACE(K_TRACE_TIMER, 0, 0, expTimerPtr)
 		/* ... followed by that bump: */
 		dTimOneShotList->funPtr(dTimOneShotList->argsPtr);
 		kTimerPut(expTimerPtr);
@@ -174,6 +176,7 @@ BOOL kTimerHandler(void)
 	while (dTimReloadList->dTicks == 0 && dTimReloadList)
 	{
 		putRelTimerPtr = dTimReloadList;
+		K_TRACE(K_TRACE_TIMER, 0, 0, putRelTimerPtr)
 		kMemCpy(&timReloadCpy, dTimReloadList, TIMER_SIZE);
 		kTimerPut(putRelTimerPtr);
 		dTimReloadList->funPtr(dTimReloadList->argsPtr);
@@ -212,6 +215,7 @@ void kSleep(TICK ticks)
 		if (!kTCBQEnq(&sleepingQueue, runPtr))
 		{
 			runPtr->status = SLEEPING;
+			K_TRACE_BLOCK(NULL)
 			runPtr->pendingTmr = (K_TIMER*) (dTimSleepList);
 
 			K_PEND_CTXTSWTCH
@@ -266,6 +270,7 @@ VOID kSleepUntil(TICK const period)
 			if (!kTCBQEnq(&sleepingQueue, runPtr))
 			{
 				runPtr->status = SLEEPING;
+				K_TRACE_BLOCK(NULL)
 				runPtr->pendingTmr = (K_TIMER*) (dTimSleepList);
 
 				K_PEND_CTXTSWTCH
@@ -301,17 +306,38 @@ VOID kTimeOut(K_TIMEOUT_NODE *timeOutNode, TICK timeout)
 
 	}
 }
+/* Remove a node from the timeout list, if it is there */
+VOID kTimeOutCancel(K_TIMEOUT_NODE *timeOutNode)
+{
+	K_TIMEOUT_NODE **currentPtr = &timeOutListHeadPtr;
+	while (*currentPtr != NULL)
+	{
+		if (*currentPtr == timeOutNode)
+		{
+			*currentPtr = timeOutNode->nextPtr;
+			timeOutNode->nextPtr = NULL;
+			timeOutNode->timeout = 0;
+			return;
+		}
+		currentPtr = &((*currentPtr)->nextPtr);
+	}
+}
+
 /* Handler traverses the list and process each object accordinly */
 #if (K_DEF_MBOX==ON)
 
 VOID kRemoveTaskFromMbox(ADDR kobj)
 {
 	K_MBOX *mboxPtr = (K_MBOX*) kobj;
+	/* at most one of the queues is not empty */
+	K_TCBQ *waitQPtr =
+			(mboxPtr->sendersQueue.size > 0) ?
+					&mboxPtr->sendersQueue : &mboxPtr->receiversQueue;
 
-	if (mboxPtr->waitingQueue.size > 0)
+	if (waitQPtr->size > 0)
 	{
 		K_TCB *taskPtr;
-		kTCBQDeq(&mboxPtr->waitingQueue, &taskPtr);
+		kTCBQDeq(waitQPtr, &taskPtr);
 		taskPtr->timeOut = TRUE;
 		if (!kTCBQEnq(&readyQueue[taskPtr->priority], taskPtr))
 		{
@@ -363,17 +389,21 @@ VOID kRemoveTaskFromMutex(ADDR kobj)
 }
 #endif
 
-#if (K_DEF_SYNCH_MESGQ==ON)
+#if (K_DEF_MESGQ==ON)
 
 VOID kRemoveTaskFromQueue(ADDR kobj)
 {
 
 	K_MESGQ *queuePtr = (K_MESGQ*) kobj;
+	/* at most one of the queues is not empty */
+	K_TCBQ *waitQPtr =
+			(queuePtr->sendersQueue.size > 0) ?
+					&queuePtr->sendersQueue : &queuePtr->receiversQueue;
 
-	if (queuePtr->waitingQueue.size > 0)
+	if (waitQPtr->size > 0)
 	{
 		K_TCB *taskPtr;
-		kTCBQDeq(&queuePtr->waitingQueue, &taskPtr);
+		kTCBQDeq(waitQPtr, &taskPtr);
 
 		taskPtr->timeOut = TRUE;
 
@@ -384,6 +414,28 @@ VOID kRemoveTaskFromQueue(ADDR kobj)
 	}
 }
 
+#endif
+#if (K_DEF_PMESGQ==ON)
+
+VOID kRemoveTaskFromPMesgQ(ADDR kobj)
+{
+	struct kPMesgQWait *waitPtr = (struct kPMesgQWait*) kobj;
+	K_TCB *taskPtr = waitPtr->tcbPtr;
+
+	/* the task that serves a waiter cancels its node first */
+	if ((taskPtr->status == SENDING) || (taskPtr->status == RECEIVING))
+	{
+		kTCBQRem((taskPtr->status == SENDING) ?
+				&waitPtr->queuePtr->sendersQueue :
+				&waitPtr->queuePtr->receiversQueue, &taskPtr);
+		taskPtr->timeOut = TRUE;
+		if (!kTCBQEnq(&readyQueue[taskPtr->priority], taskPtr))
+		{
+			taskPtr->status = READY;
+		}
+	}
+}
+
 #endif
 #if (K_DEF_SLEEPWAKE==ON)
 
@@ -405,6 +457,117 @@ VOID kRemoveTaskFromEvent(ADDR kobj)
 }
 #endif
 
+#if (K_DEF_TASK_NOTIFY==ON)
+
+VOID kRemoveTaskFromNotify(ADDR kobj)
+{
+	K_TCB *taskPtr = (K_TCB*) kobj;
+
+	if ((taskPtr->status == PENDING) && (taskPtr->notifyWait == TRUE))
+	{
+		kTCBQRem(&sleepingQueue, &taskPtr);
+		taskPtr->notifyWait = FALSE;
+		taskPtr->timeOut = TRUE;
+		if (!kTCBQEnq(&readyQueue[taskPtr->priority], taskPtr))
+		{
+			taskPtr->status = READY;
+		}
+	}
+}
+#endif
+
+#if (K_DEF_BCAST==ON)
+VOID kRemoveTaskFromBcastReader(ADDR kobj)
+{
+	K_BCAST_READER *readerPtr = (K_BCAST_READER*) kobj;
+	K_TCB *taskPtr = readerPtr->waitingPtr;
+
+	if (taskPtr != NULL)
+	{
+		kTCBQRem(&readerPtr->ringPtr->readersQueue, &taskPtr);
+		readerPtr->waitingPtr = NULL;
+		taskPtr->timeOut = TRUE;
+		if (!kTCBQEnq(&readyQueue[taskPtr->priority], taskPtr))
+		{
+			taskPtr->status = READY;
+		}
+	}
+}
+
+VOID kRemoveTaskFromBcastWriter(ADDR kobj)
+{
+	K_BCAST *ringPtr = (K_BCAST*) kobj;
+
+	if (ringPtr->writerQueue.size > 0)
+	{
+		K_TCB *taskPtr;
+		kTCBQDeq(&ringPtr->writerQueue, &taskPtr);
+		taskPtr->timeOut = TRUE;
+		if (!kTCBQEnq(&readyQueue[taskPtr->priority], taskPtr))
+		{
+			taskPtr->status = READY;
+		}
+	}
+}
+#endif
+
+#if (K_DEF_BUS==ON)
+VOID kRemoveTaskFromBusSub(ADDR kobj)
+{
+	K_BUS_SUB *subPtr = (K_BUS_SUB*) kobj;
+	K_TCB *taskPtr = subPtr->waitingPtr;
+
+	if (taskPtr != NULL)
+	{
+		kTCBQRem(&subPtr->topicPtr->waitingQueue, &taskPtr);
+		subPtr->waitingPtr = NULL;
+		taskPtr->timeOut = TRUE;
+		if (!kTCBQEnq(&readyQueue[taskPtr->priority], taskPtr))
+		{
+			taskPtr->status = READY;
+		}
+	}
+}
+#endif
+
+#if (K_DEF_RDV==ON)
+VOID kRemoveTaskFromRdvCaller(ADDR kobj)
+{
+	struct kRdvCall *callPtr = (struct kRdvCall*) kobj;
+	K_RDV *rdvPtr = callPtr->rdvPtr;
+	K_TCB *taskPtr = callPtr->tcbPtr;
+
+	/* a client that was not accepted yet */
+	kTCBQRem(&rdvPtr->callersQueue, &taskPtr);
+	taskPtr->timeOut = TRUE;
+	if (!kTCBQEnq(&readyQueue[taskPtr->priority], taskPtr))
+	{
+		taskPtr->status = READY;
+	}
+	if (rdvPtr->ownerPtr != NULL)
+	{
+		/* a busy server no longer runs at this client priority */
+		kRdvServerPrio(rdvPtr, rdvPtr->ownerPtr);
+	}
+}
+
+VOID kRemoveTaskFromRdvServer(ADDR kobj)
+{
+	K_RDV *rdvPtr = (K_RDV*) kobj;
+	K_TCB *taskPtr = rdvPtr->serverPtr;
+
+	if (taskPtr != NULL)
+	{
+		rdvPtr->serverPtr = NULL;
+		taskPtr->timeOut = TRUE;
+		if (!kTCBQEnq(&readyQueue[taskPtr->priority], taskPtr))
+		{
+			taskPtr->status = READY;
+		}
+	}
+}
+#endif
+
 BOOL kHandleTimeoutList(void)
 {
 	K_TIMEOUT_NODE **currentPtr = &timeOutListHeadPtr;
@@ -424,6 +587,7 @@ BOOL kHandleTimeoutList(void)
 			ret = TRUE;
 			/* rem the node from the timeout list */
 			*currentPtr = node->nextPtr;
+			K_TRACE(K_TRACE_TIMEOUT, 0, node->objectType, node->kobj)
 
 			/* Handle the timeout for the associated kernel object */
 			switch (node->objectType)
@@ -446,16 +610,51 @@ BOOL kHandleTimeoutList(void)
 				kRemoveTaskFromMutex(node->kobj);
 				break;
 #endif
-#if (K_DEF_SYNCH_MESGQ==ON)
+#if (K_DEF_MESGQ==ON)
 			case MESGQUEUE:
 				kRemoveTaskFromQueue(node->kobj);
 				break;
 #endif
+#if (K_DEF_PMESGQ==ON)
+			case PMESGQUEUE:
+				kRemoveTaskFromPMesgQ(node->kobj);
+				break;
+#endif
 #if (K_DEF_SLEEPWAKE==ON)
 
 			case EVENT:
 				kRemoveTaskFromEvent(node->kobj);
 				break;
+#endif
+#if (K_DEF_TASK_NOTIFY==ON)
+
+			case TASKNOTIFY:
+				kRemoveTaskFromNotify(node->kobj);
+				break;
+#endif
+#if (K_DEF_BCAST==ON)
+
+			case BCASTREADER:
+				kRemoveTaskFromBcastReader(node->kobj);
+				break;
+			case BCASTWRITER:
+				kRemoveTaskFromBcastWriter(node->kobj);
+				break;
+#endif
+#if (K_DEF_BUS==ON)
+
+			case BUSSUB:
+				kRemoveTaskFromBusSub(node->kobj);
+				break;
+#endif
+#if (K_DEF_RDV==ON)
+
+			case RDVCALLER:
+				kRemoveTaskFromRdvCaller(node->kobj);
+				break;
+			case RDVSERVER:
+				kRemoveTaskFromRdvServer(node->kobj);
+				break;
 #endif
 			default:
 				KFAULT(FAULT);
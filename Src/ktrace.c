@@ -0,0 +1,100 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.3.1]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  Module           : Trace Recorder
+ *  Depends on       : -
+ *  Provides to      : All services
+ *  Public API       : Yes
+ *
+ *  In this unit:
+ *  				 Kernel event trace on a RAM ring
+ *
+ *****************************************************************************/
+
+/*******************************************************************************
+ * Every event is a three-word record: a DWT cycle stamp, the event, a task
+ * ID, a 16-bit argument and an object address. A record slot is claimed
+ * with one exclusive add on the head, so recording never masks interrupts
+ * and can be called from any context.
+ *
+ * The ring always keeps the last K_DEF_TRACE_DEPTH events (flight recorder).
+ * kTrace is dumped as is, e.g. from the debugger:
+ *
+ *   dump binary memory trace.bin &kTrace (&kTrace + 1)
+ *
+ * and tools/ktrace.py turns the dump into a Perfetto/Chrome JSON timeline.
+ ******************************************************************************/
+
+#define K_CODE
+#include "kconfig.h"
+#include "kobjs.h"
+#include "kinternals.h"
+#include "ksch.h"
+#include "katomic.h"
+#include "ktrace.h"
+
+#if (K_DEF_TRACE==ON)
+
+#if ((K_DEF_TRACE_DEPTH & (K_DEF_TRACE_DEPTH - 1)) != 0)
+#error "K_DEF_TRACE_DEPTH must be a power of two"
+#endif
+
+#define K_TRACE_MAGIC (0x4B545243) /* "KTRC" */
+
+K_TRACE_BUF kTrace;
+
+VOID kTraceInit(VOID)
+{
+	kTrace.magic = K_TRACE_MAGIC;
+	kTrace.depth = K_DEF_TRACE_DEPTH;
+	kTrace.cpuHz = SystemCoreClock;
+	kTrace.head = 0;
+	kTrace.on = TRUE;
+}
+
+VOID kTraceRecord(K_TRACE_EVT const evt, PID const pid, UINT16 const arg,
+		ADDR const obj)
+{
+	if (!kTrace.on)
+	{
+		return;
+	}
+	UINT32 stamp = K_CYCLE_CNT;
+	UINT32 idx = kAtomicAdd(&kTrace.head, 1) - 1U;
+	K_TRACE_REC *recPtr = &kTrace.rec[idx & (K_DEF_TRACE_DEPTH - 1U)];
+	recPtr->stamp = stamp;
+	recPtr->evt = (BYTE) evt;
+	recPtr->pid = pid;
+	recPtr->arg = arg;
+	recPtr->obj = (UINT32) obj;
+}
+
+VOID kTraceStart(VOID)
+{
+	kTrace.on = TRUE;
+}
+
+VOID kTraceStop(VOID)
+{
+	kTrace.on = FALSE;
+}
+
+VOID kTraceISREnter(VOID)
+{
+	kTraceRecord(K_TRACE_ISR_ENTER, runPtr->pid, (UINT16) kIsISR(), NULL);
+}
+
+VOID kTraceISRExit(VOID)
+{
+	kTraceRecord(K_TRACE_ISR_EXIT, runPtr->pid, (UINT16) kIsISR(), NULL);
+}
+
+VOID kTraceUser(UINT16 const id, ADDR const valPtr)
+{
+	kTraceRecord(K_TRACE_USER, runPtr->pid, id, valPtr);
+}
+
+#endif /* K_DEF_TRACE */
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""
+K0BA crash dump decoder.
+
+Prints the record saved by K_DEF_CRASHDUMP, dumped from the debugger or sent
+by the application on the boot after the fault:
+
+    (gdb) dump binary memory crash.bin &kCrashDump (&kCrashDump + 1)
+    $ python3 tools/kcrash.py crash.bin
+
+Layout (little endian, see struct kCrashDump in Inc/kobjs.h):
+    28 x UINT32 header, nTasks x (sp, stackAddr, stackSize UINT32,
+    pid, tid, status, priority BYTE), then nTrace trace records
+    (stamp UINT32, evt BYTE, pid BYTE, arg UINT16, obj UINT32).
+The raw TCB copy that follows is left to the debugger.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x4B435253
+HEADER = struct.Struct("<28I")
+TASK = struct.Struct("<IIIBBBB")
+TRACE = struct.Struct("<IBBHI")
+
+FIELDS = ("magic size checksum pending nCrashes fault tick hasFrame "
+          "r0 r1 r2 r3 r12 frameLr pc xpsr lr msp psp ipsr cfsr hfsr mmfar bfar "
+          "runPtr readyMask nTasks nTrace").split()
+
+# K_FAULT (Inc/ktypes.h)
+FAULTS = {
+    0x00: "FAULT", 0x01: "FAULT_READY_QUEUE", 0x02: "FAULT_NULL_OBJ",
+    0x03: "FAULT_LIST", 0x04: "FAULT_KERNEL_VERSION",
+    0x05: "FAULT_QUEUE_ROOM", 0x06: "FAULT_QUEUE_MESG_CPY",
+    0x07: "FAULT_QUEUE_MEM_FREE", 0x08: "FAULT_QUEUE_LIST_ADD",
+    0x09: "FAULT_QUEUE_LIST_REM", 0x0A: "FAULT_SYS_MESG_GET",
+    0x0B: "FAULT_SYS_MESG_PUT", 0x0C: "FAULT_MEM_ALLOC",
+    0x0D: "FAULT_MEM_FREE", 0x0E: "FAULT_OBJ_NOT_INIT",
+    0x0F: "FAULT_MEM_CPY", 0x1F: "FAULT_INVALID_TASK_PRIO",
+    0x2F: "FAULT_INVALID_TASK_ID", 0x3F: "FAULT_OBJ_INIT",
+    0x4F: "FAULT_SYSMESG_N_EXCEEDED", 0x5F: "FAULT_UNLOCK_OWNED_MUTEX",
+    0x6F: "FAULT_ISR_INVALID_PRIMITVE", 0x7F: "FAULT_TASK_INVALID_STATE",
+    0x8F: "FAULT_CPU_EXCEPTION", 0xFF: "FAULT_INVALID_SVC",
+}
+
+EXCEPTIONS = {0: "thread", 2: "NMI", 3: "HardFault", 4: "MemManage",
+              5: "BusFault", 6: "UsageFault", 11: "SVCall", 14: "PendSV",
+              15: "SysTick"}
+
+# K_TASK_STATUS (Inc/ktypes.h)
+STATUS = ["INVALID", "READY", "RUNNING", "PENDING", "SLEEPING", "BLOCKED",
+          "SUSPENDED", "SENDING", "RECEIVING"]
+
+# K_TRACE_EVT (Inc/ktypes.h)
+EVENTS = ["?", "SWITCH", "READY", "BLOCK", "TIMEOUT", "TIMER", "ISR_ENTER",
+          "ISR_EXIT", "USER"]
+
+CFSR_BITS = [
+    (0, "IACCVIOL"), (1, "DACCVIOL"), (3, "MUNSTKERR"), (4, "MSTKERR"),
+    (5, "MLSPERR"), (7, "MMARVALID"), (8, "IBUSERR"), (9, "PRECISERR"),
+    (10, "IMPRECISERR"), (11, "UNSTKERR"), (12, "STKERR"), (13, "LSPERR"),
+    (15, "BFARVALID"), (16, "UNDEFINSTR"), (17, "INVSTATE"), (18, "INVPC"),
+    (19, "NOCP"), (24, "UNALIGNED"), (25, "DIVBYZERO"),
+]
+HFSR_BITS = [(1, "VECTTBL"), (30, "FORCED"), (31, "DEBUGEVT")]
+
+
+def bits(value, table):
+    names = [name for bit, name in table if value & (1 << bit)]
+    return " ".join(names) if names else "-"
+
+
+def name(table, idx):
+    return table[idx] if idx < len(table) else str(idx)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("dump", help="binary dump of kCrashDump")
+    ap.add_argument("--task", action="append", default=[], metavar="PID=NAME")
+    opts = ap.parse_args()
+
+    with open(opts.dump, "rb") as f:
+        blob = f.read()
+    if len(blob) < HEADER.size:
+        sys.exit("dump too short")
+    h = dict(zip(FIELDS, HEADER.unpack_from(blob, 0)))
+    if h["magic"] != MAGIC:
+        sys.exit("no crash record (bad magic 0x%08X)" % h["magic"])
+    names = dict((int(p), n) for p, n in (t.split("=", 1) for t in opts.task))
+
+    print("fault      %s (0x%02X), crash #%u at tick %u%s" % (
+        FAULTS.get(h["fault"], "?"), h["fault"], h["nCrashes"], h["tick"],
+        "" if h["pending"] else " [already read]"))
+    exc = h["ipsr"] & 0x1FF
+    print("context    %s (IPSR %u)" % (EXCEPTIONS.get(exc, "IRQ%d" % (exc - 16)),
+                                        exc))
+    if h["hasFrame"]:
+        print("frame      pc 0x%08X  lr 0x%08X  xpsr 0x%08X" % (
+            h["pc"], h["frameLr"], h["xpsr"]))
+        print("           r0 0x%08X  r1 0x%08X  r2 0x%08X  r3 0x%08X  "
+              "r12 0x%08X" % (h["r0"], h["r1"], h["r2"], h["r3"], h["r12"]))
+        print("exc_return 0x%08X" % h["lr"])
+    else:
+        print("caller     0x%08X (kErrHandler)" % h["lr"])
+    print("msp        0x%08X  psp 0x%08X" % (h["msp"], h["psp"]))
+    print("cfsr       0x%08X  %s" % (h["cfsr"], bits(h["cfsr"], CFSR_BITS)))
+    print("hfsr       0x%08X  %s" % (h["hfsr"], bits(h["hfsr"], HFSR_BITS)))
+    if h["cfsr"] & (1 << 7):
+        print("mmfar      0x%08X" % h["mmfar"])
+    if h["cfsr"] & (1 << 15):
+        print("bfar       0x%08X" % h["bfar"])
+    print("ready      0x%08X" % h["readyMask"])
+
+    off = HEADER.size
+    print("\n pid tid prio status       sp          stack              used")
+    for _ in range(h["nTasks"]):
+        sp, base, size, pid, tid, status, prio = TASK.unpack_from(blob, off)
+        off += TASK.size
+        top = base + 4 * size
+        used = top - sp
+        flag = "  OVERFLOW" if not base <= sp <= top else ""
+        print("%4u %3u %4u %-10s 0x%08X  0x%08X-0x%08X %5d B%s%s" % (
+            pid, tid, prio, name(STATUS, status), sp, base, top, used, flag,
+            "  (%s)" % names[pid] if pid in names else ""))
+
+    if h["nTrace"]:
+        print("\nlast %u trace events (oldest first):" % h["nTrace"])
+        first = None
+        for _ in range(h["nTrace"]):
+            stamp, evt, pid, arg, obj = TRACE.unpack_from(blob, off)
+            off += TRACE.size
+            first = stamp if first is None else first
+            print("  %+10d cy  %-9s pid %3u  arg 0x%04X  obj 0x%08X" % (
+                (stamp - first) & 0xFFFFFFFF, name(EVENTS, evt), pid, arg, obj))
+
+
+if __name__ == "__main__":
+    main()
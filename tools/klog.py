@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+K0BA binary log decoder.
+
+Formats the frames sent by kLogTask with K_DEF_LOG_BINARY, reading the
+format strings (and %s arguments) from the firmware ELF:
+
+    $ python3 tools/klog.py firmware.elf capture.bin
+    $ python3 tools/klog.py firmware.elf /dev/ttyACM0 --follow
+
+Frame (little endian, see Src/klog.c):
+    'K' 'L' stamp:UINT32 fmt:UINT32 pid:BYTE nArgs:BYTE args:nArgs x UINT32
+A frame with fmt == 0 carries [lost records, cycle counter frequency].
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = b"KL"
+HEAD = struct.Struct("<IIBB")
+PID_ISR = 0xFF
+NARGS = 4
+
+SPEC = re.compile(r"%([-+ #0]*)(\d*|\*)(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+class Elf:
+    """Loaded sections of a 32-bit little endian ELF."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            blob = f.read()
+        if blob[:4] != b"\x7fELF" or blob[4] != 1:
+            sys.exit("%s: not a 32-bit ELF" % path)
+        shoff, = struct.unpack_from("<I", blob, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", blob, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (_, sh_type, flags, addr, off, size) = struct.unpack_from(
+                "<IIIIII", blob, shoff + i * shentsize)
+            # SHF_ALLOC, with contents (not NOBITS)
+            if (flags & 0x2) and sh_type != 8 and size > 0:
+                self.sections.append((addr, blob[off:off + size]))
+
+    def string(self, addr):
+        for base, data in self.sections:
+            if base <= addr < base + len(data):
+                end = data.find(b"\0", addr - base)
+                if end < 0:
+                    end = len(data)
+                return data[addr - base:end].decode("utf-8", "replace")
+        return None
+
+
+def c_format(elf, fmt, args):
+    """printf with word arguments; length modifiers are dropped."""
+    args = list(args)
+
+    def one(m):
+        flags, width, prec, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+        val = args.pop(0) if args else 0
+        spec = "%" + flags + width + ("." + prec if prec else "")
+        if conv in "di":
+            val = val - (1 << 32) if val & 0x80000000 else val
+            return (spec + "d") % val
+        if conv == "c":
+            return (spec + "c") % chr(val & 0xFF)
+        if conv == "s":
+            s = elf.string(val)
+            return (spec + "s") % (s if s is not None else "<0x%08X>" % val)
+        if conv == "p":
+            return "0x%08x" % val
+        return (spec + conv) % val
+
+    return SPEC.sub(one, fmt)
+
+
+def frames(stream):
+    buf = b""
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                buf = buf[-1:]
+                break
+            if len(buf) < start + 2 + HEAD.size:
+                buf = buf[start:]
+                break
+            stamp, fmt, pid, nargs = HEAD.unpack_from(buf, start + 2)
+            if nargs > NARGS:
+                buf = buf[start + 1:]  # not a frame, resync
+                continue
+            end = start + 2 + HEAD.size + 4 * nargs
+            if len(buf) < end:
+                buf = buf[start:]
+                break
+            args = struct.unpack_from("<%dI" % nargs, buf, start + 2 + HEAD.size)
+            buf = buf[end:]
+            yield stamp, fmt, pid, args
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("elf", help="firmware ELF the log was produced by")
+    ap.add_argument("capture", help="binary capture (file or serial device)")
+    ap.add_argument("--follow", action="store_true",
+                    help="keep reading (serial device)")
+    ap.add_argument("--task", action="append", default=[], metavar="PID=NAME")
+    opts = ap.parse_args()
+
+    elf = Elf(opts.elf)
+    names = dict((int(p), n) for p, n in (t.split("=", 1) for t in opts.task))
+    cpu_hz = 0
+    with open(opts.capture, "rb", buffering=0 if opts.follow else -1) as f:
+        for stamp, fmt, pid, args in frames(f):
+            if fmt == 0:
+                lost, cpu_hz = (tuple(args) + (0, 0))[:2]
+                if lost:
+                    print("(log: %u records lost)" % lost)
+                continue
+            when = ("%14.3f us" % (stamp * 1e6 / cpu_hz) if cpu_hz
+                    else "%12u cy" % stamp)
+            who = "ISR" if pid == PID_ISR else names.get(pid, "%3u" % pid)
+            text = elf.string(fmt)
+            if text is None:
+                text = "<bad format 0x%08X>" % fmt
+            sys.stdout.write("[%s] %s: %s" % (when, who, c_format(elf, text, args)))
+            if not text.endswith("\n"):
+                sys.stdout.write("\n")
+            sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
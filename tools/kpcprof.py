@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""
+K0BA PC sampling profile report.
+
+Symbolizes the sample table of K_DEF_PCSAMPLE against the firmware ELF:
+
+    (gdb) dump binary memory pcs.bin &kPcSample (&kPcSample + 1)
+    $ python3 tools/kpcprof.py firmware.elf pcs.bin
+    $ python3 tools/kpcprof.py firmware.elf pcs.bin --folded > pcs.folded
+    $ flamegraph.pl pcs.folded > pcs.svg
+
+Layout (little endian, see struct kPcSampleBuf in Inc/kobjs.h):
+    8 x UINT32 header, nTasks x UINT32 samples per PID, then nSlots slots
+    (addr UINT32, count UINT16, pid BYTE, reserved BYTE).
+"""
+
+import argparse
+import collections
+import struct
+import sys
+
+MAGIC = 0x4B504353
+HEADER = struct.Struct("<8I")
+SLOT = struct.Struct("<IHBB")
+
+FIELDS = "magic nSlots shift nTasks on nSamples nHandler nDropped".split()
+
+
+class Symbols:
+    """FUNC symbols of a 32-bit little endian ELF, sorted by address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            blob = f.read()
+        if blob[:4] != b"\x7fELF" or blob[4] != 1:
+            sys.exit("%s: not a 32-bit ELF" % path)
+        shoff, = struct.unpack_from("<I", blob, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", blob, 0x2E)
+        heads = [struct.unpack_from("<IIIIIIIIII", blob, shoff + i * shentsize)
+                 for i in range(shnum)]
+        self.funcs = []
+        for sh in heads:
+            # SHT_SYMTAB; sh_link is its string table
+            if sh[1] != 2:
+                continue
+            strtab = heads[sh[6]]
+            strs = blob[strtab[4]:strtab[4] + strtab[5]]
+            for off in range(sh[4], sh[4] + sh[5], 16):
+                st_name, value, size, info = struct.unpack_from(
+                    "<IIIB", blob, off)
+                # STT_FUNC
+                if info & 0xF != 2:
+                    continue
+                end = strs.find(b"\0", st_name)
+                name = strs[st_name:end].decode("utf-8", "replace")
+                # the Thumb bit is not part of the address
+                self.funcs.append((value & ~1, max(size, 1), name))
+        self.funcs.sort()
+
+    def lookup(self, lo, hi):
+        """Name of the function covering [lo, hi), '?' if none."""
+        best = None
+        for start, size, name in self.funcs:
+            if start >= hi:
+                break
+            if start + size > lo:
+                best = name
+                # a range may straddle two functions; take the first
+                if start <= lo:
+                    return name
+        return best or "0x%08X" % lo
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("elf", help="firmware ELF the samples were taken on")
+    ap.add_argument("dump", help="binary dump of kPcSample")
+    ap.add_argument("--task", action="append", default=[], metavar="PID=NAME")
+    ap.add_argument("--folded", action="store_true",
+                    help="print 'task;function count' lines for a flame graph")
+    ap.add_argument("--top", type=int, default=20,
+                    help="functions listed per task (default 20)")
+    opts = ap.parse_args()
+
+    with open(opts.dump, "rb") as f:
+        blob = f.read()
+    if len(blob) < HEADER.size:
+        sys.exit("dump too short")
+    h = dict(zip(FIELDS, HEADER.unpack_from(blob, 0)))
+    if h["magic"] != MAGIC:
+        sys.exit("no sample table (bad magic 0x%08X)" % h["magic"])
+    off = HEADER.size
+    per_task = struct.unpack_from("<%dI" % h["nTasks"], blob, off)
+    off += 4 * h["nTasks"]
+
+    syms = Symbols(opts.elf)
+    names = dict((int(p), n) for p, n in (t.split("=", 1) for t in opts.task))
+    span = 1 << h["shift"]
+    counts = collections.Counter()
+    saturated = 0
+    for _ in range(h["nSlots"]):
+        addr, count, pid, _ = SLOT.unpack_from(blob, off)
+        off += SLOT.size
+        if addr == 0:
+            continue
+        saturated += count == 0xFFFF
+        counts[(pid, syms.lookup(addr, addr + span))] += count
+
+    def task(pid):
+        return names.get(pid, "pid%u" % pid)
+
+    if opts.folded:
+        for (pid, func), n in sorted(counts.items()):
+            print("%s;%s %u" % (task(pid), func, n))
+        if h["nHandler"]:
+            print("handler %u" % h["nHandler"])
+        return
+
+    total = h["nSamples"]
+    print("%u samples, %u in handlers, %u dropped, %u B ranges%s" % (
+        total, h["nHandler"], h["nDropped"], span,
+        "" if h["on"] else " [stopped]"))
+    if saturated:
+        print("%u slots saturated; counts are low" % saturated)
+    by_task = collections.defaultdict(list)
+    for (pid, func), n in counts.items():
+        by_task[pid].append((n, func))
+    for pid in sorted(by_task, key=lambda p: -per_task[p]
+                      if p < len(per_task) else 0):
+        n_task = per_task[pid] if pid < len(per_task) else 0
+        print("\n%s: %u samples (%.1f%%)" % (
+            task(pid), n_task, 100.0 * n_task / total if total else 0))
+        for n, func in sorted(by_task[pid], reverse=True)[:opts.top]:
+            print("  %8u %5.1f%%  %s" % (n, 100.0 * n / n_task if n_task
+                                         else 0, func))
+
+
+if __name__ == "__main__":
+    main()
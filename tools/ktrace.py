@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""
+K0BA trace decoder.
+
+Converts a raw dump of the kTrace ring (K_DEF_TRACE) into a Chrome/Perfetto
+JSON timeline (open it on ui.perfetto.dev or chrome://tracing):
+
+    (gdb) dump binary memory trace.bin &kTrace (&kTrace + 1)
+    $ python3 tools/ktrace.py trace.bin -o trace.json
+
+Each task is a track with its running slices; blocks, readies, time-outs,
+timers and user events are instants; interrupts are slices on their own
+track. Task names can be given as --task PID=NAME.
+
+Layout (little endian, see struct kTraceBuf/kTraceRec in Inc/kobjs.h):
+    magic, depth, cpuHz, head, on           5 x UINT32
+    depth records of: stamp UINT32, evt BYTE, pid BYTE, arg UINT16, obj UINT32
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x4B545243
+HEADER = struct.Struct("<5I")
+RECORD = struct.Struct("<IBBHI")
+
+# K_TRACE_EVT (Inc/ktypes.h)
+SWITCH, READY, BLOCK, TIMEOUT, TIMER, ISR_ENTER, ISR_EXIT, USER = range(1, 9)
+
+# K_TASK_STATUS (Inc/ktypes.h)
+STATUS = ["INVALID", "READY", "RUNNING", "PENDING", "SLEEPING", "BLOCKED",
+          "SUSPENDED", "SENDING", "RECEIVING"]
+
+ISR_TRACK = 1000
+KERNEL_TRACK = 1001
+
+
+def records(blob):
+    magic, depth, _, head, _ = HEADER.unpack_from(blob, 0)
+    if magic != MAGIC:
+        sys.exit("not a K0BA trace (bad magic 0x%08X)" % magic)
+    count = min(head, depth)
+    first = head - count
+    for idx in range(first, head):
+        off = HEADER.size + (idx % depth) * RECORD.size
+        yield RECORD.unpack_from(blob, off)
+
+
+def status_name(status):
+    return STATUS[status] if status < len(STATUS) else str(status)
+
+
+def convert(blob, names):
+    events = []
+    cpu_hz = HEADER.unpack_from(blob, 0)[2] or 1
+    us_per_cycle = 1e6 / cpu_hz
+    last = None
+    now = 0
+    running = None
+
+    def instant(track, name, args):
+        events.append({"ph": "i", "s": "t", "pid": 0, "tid": track,
+                       "ts": now * us_per_cycle, "name": name, "args": args})
+
+    for stamp, evt, pid, arg, obj in records(blob):
+        # 32-bit cycle counter: accumulate the wrapped deltas
+        now += 0 if last is None else (stamp - last) & 0xFFFFFFFF
+        last = stamp
+        ts = now * us_per_cycle
+        if evt == SWITCH:
+            prev, why = arg & 0xFF, arg >> 8
+            if running is not None:
+                events.append({"ph": "E", "pid": 0, "tid": prev, "ts": ts,
+                               "args": {"out": status_name(why)}})
+            events.append({"ph": "B", "pid": 0, "tid": pid, "ts": ts,
+                           "name": "run"})
+            running = pid
+        elif evt == READY:
+            instant(pid, "ready", {"obj": "0x%08X" % obj})
+        elif evt == BLOCK:
+            instant(pid, "block", {"status": status_name(arg),
+                                   "obj": "0x%08X" % obj})
+        elif evt == TIMEOUT:
+            instant(KERNEL_TRACK, "timeout", {"type": arg,
+                                              "obj": "0x%08X" % obj})
+        elif evt == TIMER:
+            instant(KERNEL_TRACK, "timer", {"obj": "0x%08X" % obj})
+        elif evt == ISR_ENTER:
+            events.append({"ph": "B", "pid": 0, "tid": ISR_TRACK, "ts": ts,
+                           "name": "irq %d" % arg})
+        elif evt == ISR_EXIT:
+            events.append({"ph": "E", "pid": 0, "tid": ISR_TRACK, "ts": ts})
+        elif evt == USER:
+            instant(pid, "user %d" % arg, {"val": "0x%08X" % obj})
+
+    tracks = {ISR_TRACK: "interrupts", KERNEL_TRACK: "kernel"}
+    tracks.update(names)
+    for tid, name in tracks.items():
+        events.append({"ph": "M", "pid": 0, "tid": tid, "name": "thread_name",
+                       "args": {"name": name}})
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("dump", help="raw dump of kTrace")
+    ap.add_argument("-o", "--output", default="-", help="JSON output file")
+    ap.add_argument("--task", action="append", default=[],
+                    metavar="PID=NAME", help="name a task track")
+    args = ap.parse_args()
+
+    names = {}
+    for item in args.task:
+        pid, name = item.split("=", 1)
+        names[int(pid, 0)] = name
+
+    with open(args.dump, "rb") as f:
+        trace = convert(f.read(), names)
+    out = sys.stdout if args.output == "-" else open(args.output, "w")
+    json.dump(trace, out)
+    if out is not sys.stdout:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()